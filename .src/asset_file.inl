@@ -0,0 +1,320 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/31/22 by clem (mail@clemens-cords.com)
+//
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rat
+{
+    AssetFile::AssetFile()
+    {}
+
+    AssetFile::~AssetFile()
+    {
+        close();
+    }
+
+    bool AssetFile::open(const std::string& path)
+    {
+        close();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            std::cerr << "[WARNING] In AssetFile::open: Unable to open file at `" << path << "`" << std::endl;
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 or size_t(info.st_size) < sizeof(Header))
+        {
+            std::cerr << "[WARNING] In AssetFile::open: File at `" << path << "` is too small to be an asset" << std::endl;
+            ::close(fd);
+            return false;
+        }
+
+        void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping keeps the file alive
+
+        if (mapped == MAP_FAILED)
+        {
+            std::cerr << "[WARNING] In AssetFile::open: Unable to map file at `" << path << "`" << std::endl;
+            return false;
+        }
+
+        _data = static_cast<const uint8_t*>(mapped);
+        _n_bytes = info.st_size;
+
+        // everything is read with memcpy, the mapping gives no alignment guarantees for the region table
+        std::memcpy(&_header, _data, sizeof(Header));
+
+        auto fail = [&](const std::string& reason) {
+            std::cerr << "[WARNING] In AssetFile::open: File at `" << path << "` is invalid: " << reason << std::endl;
+            close();
+            return false;
+        };
+
+        // offsets come from the file, compare by subtracting so that huge values cannot wrap around
+        auto in_range = [&](uint64_t offset, uint64_t n_bytes) {
+            return offset <= _n_bytes and n_bytes <= _n_bytes - offset;
+        };
+
+        if (_header.magic != _magic)
+            return fail("not a mousetrap asset");
+
+        // the version is the first integer, so it also detects files written with the other byte order
+        const uint32_t swapped_version = (_version >> 24) | ((_version >> 8) & 0xFF00) | ((_version << 8) & 0xFF0000) | (_version << 24);
+        if (_header.version == swapped_version and _header.version != _version)
+            return fail("written on a machine with different byte order");
+
+        if (_header.version != _version)
+            return fail("unsupported version " + std::to_string(_header.version));
+
+        if (_header.format != uint32_t(AssetPixelFormat::RGBA8))
+            return fail("unsupported pixel format " + std::to_string(_header.format));
+
+        if (_header.width == 0 or _header.height == 0 or _header.width > _max_size or _header.height > _max_size)
+            return fail("invalid size " + std::to_string(_header.width) + "x" + std::to_string(_header.height));
+
+        if (_header.n_levels == 0 or not in_range(sizeof(Header), uint64_t(_header.n_levels) * sizeof(Level)))
+            return fail("level table out of range");
+
+        _levels.resize(_header.n_levels);
+        std::memcpy(_levels.data(), _data + sizeof(Header), _header.n_levels * sizeof(Level));
+
+        // each level has to be half the size of the previous one, rounded down, at least 1x1
+        auto expected_size = Vector2ui(_header.width, _header.height);
+        for (auto& level : _levels)
+        {
+            if (level.width != expected_size.x or level.height != expected_size.y)
+                return fail("level size does not match the mip chain");
+
+            if (not in_range(level.offset, level.n_bytes) or level.n_bytes != uint64_t(level.width) * level.height * 4)
+                return fail("level out of range");
+
+            if (expected_size.x == 1 and expected_size.y == 1 and &level != &_levels.back())
+                return fail("more levels than the mip chain has");
+
+            expected_size = Vector2ui(std::max<size_t>(expected_size.x / 2, 1), std::max<size_t>(expected_size.y / 2, 1));
+        }
+
+        if (not in_range(_header.regions_offset, 0))
+            return fail("region table out of range");
+
+        size_t offset = _header.regions_offset;
+        for (size_t i = 0; i < _header.n_regions; ++i)
+        {
+            std::array<float, 4> rectangle;
+            uint32_t name_length;
+
+            if (not in_range(offset, sizeof(rectangle) + sizeof(name_length)))
+                return fail("region table out of range");
+
+            std::memcpy(rectangle.data(), _data + offset, sizeof(rectangle));
+            std::memcpy(&name_length, _data + offset + sizeof(rectangle), sizeof(name_length));
+            offset += sizeof(rectangle) + sizeof(name_length);
+
+            if (not in_range(offset, name_length))
+                return fail("region name out of range");
+
+            auto name = std::string(reinterpret_cast<const char*>(_data + offset), name_length);
+            offset += name_length;
+
+            // regions are copied out of the base level, so they have to be whole pixels inside of it
+            for (float value : rectangle)
+                if (not std::isfinite(value) or value < 0 or std::floor(value) != value)
+                    return fail("region `" + name + "` is not a whole-pixel rectangle");
+
+            if (rectangle.at(0) + rectangle.at(2) > _header.width or rectangle.at(1) + rectangle.at(3) > _header.height)
+                return fail("region `" + name + "` lies outside the image");
+
+            _regions.insert({name, Rectangle{{rectangle.at(0), rectangle.at(1)}, {rectangle.at(2), rectangle.at(3)}}});
+        }
+
+        // levels are usually uploaded right away
+        madvise(const_cast<uint8_t*>(_data), _n_bytes, MADV_WILLNEED);
+        return true;
+    }
+
+    void AssetFile::close()
+    {
+        if (_data != nullptr)
+            munmap(const_cast<uint8_t*>(_data), _n_bytes);
+
+        _data = nullptr;
+        _n_bytes = 0;
+        _levels.clear();
+        _regions.clear();
+    }
+
+    bool AssetFile::is_open() const
+    {
+        return _data != nullptr;
+    }
+
+    Vector2ui AssetFile::get_size() const
+    {
+        if (not is_open())
+            return {0, 0};
+
+        return {_header.width, _header.height};
+    }
+
+    AssetPixelFormat AssetFile::get_format() const
+    {
+        return AssetPixelFormat(_header.format);
+    }
+
+    size_t AssetFile::get_n_levels() const
+    {
+        return _levels.size();
+    }
+
+    Vector2ui AssetFile::get_level_size(size_t level) const
+    {
+        auto& info = _levels.at(level);
+        return {info.width, info.height};
+    }
+
+    const void* AssetFile::get_level_data(size_t level) const
+    {
+        return _data + _levels.at(level).offset;
+    }
+
+    size_t AssetFile::get_level_n_bytes(size_t level) const
+    {
+        return _levels.at(level).n_bytes;
+    }
+
+    const std::map<std::string, Rectangle>& AssetFile::get_regions() const
+    {
+        return _regions;
+    }
+
+    bool AssetFile::write(const std::string& path, Image& image, bool generate_mipmaps, const std::map<std::string, Rectangle>& regions)
+    {
+        SDL_Surface* surface = image;
+        if (surface == nullptr)
+        {
+            std::cerr << "[WARNING] In AssetFile::write: Image has not been created yet." << std::endl;
+            return false;
+        }
+
+        if (uint32_t(surface->w) > _max_size or uint32_t(surface->h) > _max_size)
+        {
+            std::cerr << "[WARNING] In AssetFile::write: Image of size " << surface->w << "x" << surface->h << " is larger than the maximum of " << _max_size << " pixels per dimension." << std::endl;
+            return false;
+        }
+
+        // level 0 without row padding, then each level is the 2x2 box-filtered previous one
+        auto pixels = std::vector<std::vector<uint8_t>>(1);
+        auto sizes = std::vector<Vector2ui>{Vector2ui(surface->w, surface->h)};
+
+        pixels.back().resize(size_t(surface->w) * surface->h * 4);
+        for (size_t y = 0; y < size_t(surface->h); ++y)
+            std::memcpy(pixels.back().data() + y * surface->w * 4, static_cast<const uint8_t*>(surface->pixels) + y * surface->pitch, surface->w * 4);
+
+        while (generate_mipmaps and (sizes.back().x > 1 or sizes.back().y > 1))
+        {
+            auto previous_size = sizes.back();
+            auto size = Vector2ui(std::max<size_t>(previous_size.x / 2, 1), std::max<size_t>(previous_size.y / 2, 1));
+
+            auto level = std::vector<uint8_t>(size.x * size.y * 4);
+            const auto& previous = pixels.back();
+
+            for (size_t y = 0; y < size.y; ++y)
+            {
+                for (size_t x = 0; x < size.x; ++x)
+                {
+                    const size_t x0 = std::min<size_t>(2 * x, previous_size.x - 1),
+                                 x1 = std::min<size_t>(2 * x + 1, previous_size.x - 1),
+                                 y0 = std::min<size_t>(2 * y, previous_size.y - 1),
+                                 y1 = std::min<size_t>(2 * y + 1, previous_size.y - 1);
+
+                    for (size_t c = 0; c < 4; ++c)
+                    {
+                        size_t sum = previous.at((y0 * previous_size.x + x0) * 4 + c) +
+                                     previous.at((y0 * previous_size.x + x1) * 4 + c) +
+                                     previous.at((y1 * previous_size.x + x0) * 4 + c) +
+                                     previous.at((y1 * previous_size.x + x1) * 4 + c);
+
+                        level.at((y * size.x + x) * 4 + c) = (sum + 2) / 4;
+                    }
+                }
+            }
+
+            pixels.push_back(std::move(level));
+            sizes.push_back(size);
+        }
+
+        auto align = [](size_t offset) {
+            return (offset + _level_alignment - 1) / _level_alignment * _level_alignment;
+        };
+
+        auto header = Header();
+        header.magic = _magic;
+        header.version = _version;
+        header.format = uint32_t(AssetPixelFormat::RGBA8);
+        header.width = surface->w;
+        header.height = surface->h;
+        header.n_levels = pixels.size();
+        header.n_regions = regions.size();
+        header.unused = 0;
+
+        auto levels = std::vector<Level>();
+        size_t offset = align(sizeof(Header) + pixels.size() * sizeof(Level));
+
+        for (size_t i = 0; i < pixels.size(); ++i)
+        {
+            levels.push_back(Level{offset, pixels.at(i).size(), uint32_t(sizes.at(i).x), uint32_t(sizes.at(i).y)});
+            offset = align(offset + pixels.at(i).size());
+        }
+
+        header.regions_offset = offset;
+
+        auto file = std::ofstream(path, std::ios::binary);
+        if (not file.is_open())
+        {
+            std::cerr << "[WARNING] In AssetFile::write: Unable to open file at `" << path << "`" << std::endl;
+            return false;
+        }
+
+        auto pad_to = [&](size_t target) {
+            static const std::array<char, _level_alignment> zeros = {};
+            size_t current = file.tellp();
+            file.write(zeros.data(), target - current);
+        };
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(Level));
+
+        for (size_t i = 0; i < pixels.size(); ++i)
+        {
+            pad_to(levels.at(i).offset);
+            file.write(reinterpret_cast<const char*>(pixels.at(i).data()), pixels.at(i).size());
+        }
+
+        pad_to(header.regions_offset);
+
+        for (auto& pair : regions)
+        {
+            std::array<float, 4> rectangle = {pair.second.top_left.x, pair.second.top_left.y, pair.second.size.x, pair.second.size.y};
+            uint32_t name_length = pair.first.size();
+
+            file.write(reinterpret_cast<const char*>(rectangle.data()), sizeof(rectangle));
+            file.write(reinterpret_cast<const char*>(&name_length), sizeof(name_length));
+            file.write(pair.first.data(), name_length);
+        }
+
+        return file.good();
+    }
+}
@@ -0,0 +1,196 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/31/22 by clem (mail@clemens-cords.com)
+//
+
+#include <iostream>
+
+namespace rat
+{
+    // HANDLE
+
+    TextureHandle::State::State(RenderTarget& target)
+        : texture(target)
+    {}
+
+    TextureHandle::TextureHandle()
+    {}
+
+    bool TextureHandle::valid() const
+    {
+        return _state != nullptr;
+    }
+
+    bool TextureHandle::is_ready() const
+    {
+        return valid() and _state->status == READY;
+    }
+
+    bool TextureHandle::has_failed() const
+    {
+        return valid() and _state->status == FAILED;
+    }
+
+    Texture* TextureHandle::get_texture() const
+    {
+        if (not valid())
+            return nullptr;
+
+        return _state->status == READY ? &_state->texture : _state->placeholder;
+    }
+
+    std::string TextureHandle::get_path() const
+    {
+        if (not valid())
+            return "";
+
+        return _state->path;
+    }
+
+    // LOADER
+
+    AssetLoader::AssetLoader(RenderTarget& target, size_t n_threads)
+        : _target(&target), _placeholder(target), _pool(n_threads)
+    {
+        _placeholder.create(1, 1, RGBA(0, 0, 0, 0));
+    }
+
+    AssetLoader::~AssetLoader()
+    {
+        // queued decodes return immediately, the pool dtor then joins the workers
+        _cancelled = true;
+    }
+
+    TextureHandle AssetLoader::load(const std::string& path, bool generate_mipmaps)
+    {
+        auto out = TextureHandle();
+
+        auto it = _cache.find(path);
+        if (it != _cache.end())
+        {
+            auto cached = it->second.lock();
+            if (cached != nullptr and cached->status != TextureHandle::FAILED)
+            {
+                out._state = cached;
+                return out;
+            }
+        }
+
+        auto state = std::make_shared<State>(*_target);
+        state->path = path;
+        state->generate_mipmaps = generate_mipmaps;
+        state->placeholder = &_placeholder;
+
+        _cache.insert_or_assign(path, state);
+        _n_pending += 1;
+
+        _pool.submit([this, state](){ decode(state); });
+
+        out._state = state;
+        return out;
+    }
+
+    void AssetLoader::decode(std::shared_ptr<State> state)
+    {
+        if (_cancelled)
+            return;
+
+        auto image = std::make_unique<Image>();
+        if (not image->load(state->path)) // already warns
+        {
+            state->status = TextureHandle::FAILED;
+            _n_pending -= 1;
+            return;
+        }
+
+        state->image = std::move(image);
+        state->status = TextureHandle::DECODED;
+
+        auto lock = std::unique_lock(_decoded_mutex);
+        _decoded.push_back(std::move(state));
+    }
+
+    size_t AssetLoader::update()
+    {
+        auto clock = Clock();
+        size_t n_bytes = 0,
+               n_ready = 0;
+
+        while (true)
+        {
+            std::shared_ptr<State> state;
+
+            {
+                auto lock = std::unique_lock(_decoded_mutex);
+                if (_decoded.empty())
+                    break;
+
+                auto size = _decoded.front()->image->get_size();
+                size_t next_bytes = size.x * size.y * 4;
+
+                // the first upload always goes through, otherwise an image larger than the budget would never load
+                if (n_ready > 0)
+                {
+                    if (_budget_bytes != 0 and n_bytes + next_bytes > _budget_bytes)
+                        break;
+
+                    if (_budget_time.as_nanoseconds() != 0 and clock.elapsed().as_nanoseconds() >= _budget_time.as_nanoseconds())
+                        break;
+                }
+
+                state = std::move(_decoded.front());
+                _decoded.pop_front();
+                n_bytes += next_bytes;
+            }
+
+            state->texture.create_from(*state->image, state->generate_mipmaps);
+            state->image.reset();
+            state->status = state->texture.valid() ? TextureHandle::READY : TextureHandle::FAILED;
+
+            _n_pending -= 1;
+            n_ready += 1;
+        }
+
+        return n_ready;
+    }
+
+    void AssetLoader::wait()
+    {
+        _pool.wait();
+
+        auto budget_bytes = _budget_bytes;
+        auto budget_time = _budget_time;
+
+        _budget_bytes = 0;
+        _budget_time = nanoseconds(0);
+        update();
+
+        _budget_bytes = budget_bytes;
+        _budget_time = budget_time;
+    }
+
+    void AssetLoader::set_upload_budget(size_t n_bytes)
+    {
+        _budget_bytes = n_bytes;
+    }
+
+    void AssetLoader::set_upload_budget(Time duration)
+    {
+        _budget_time = duration;
+    }
+
+    void AssetLoader::set_placeholder(Image& image)
+    {
+        _placeholder.create_from(image);
+    }
+
+    Texture* AssetLoader::get_placeholder()
+    {
+        return &_placeholder;
+    }
+
+    size_t AssetLoader::get_n_pending() const
+    {
+        return _n_pending;
+    }
+}
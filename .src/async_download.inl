@@ -0,0 +1,165 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/29/22 by clem (mail@clemens-cords.com)
+//
+
+#include <cstring>
+#include <iostream>
+
+namespace rat
+{
+    // ASYNC DOWNLOAD
+
+    AsyncDownload::AsyncDownload()
+    {}
+
+    AsyncDownload::AsyncDownload(std::weak_ptr<PixelBufferRing> ring, size_t slot, size_t generation)
+        : _ring(ring), _slot(slot), _generation(generation)
+    {}
+
+    bool AsyncDownload::valid() const
+    {
+        auto ring = _ring.lock();
+        return ring != nullptr and ring->_slots.at(_slot).generation == _generation;
+    }
+
+    bool AsyncDownload::is_ready() const
+    {
+        if (not valid())
+            return false;
+
+        auto& slot = _ring.lock()->_slots.at(_slot);
+        if (slot.fence == nullptr)
+            return true;
+
+        auto status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        return status == GL_ALREADY_SIGNALED or status == GL_CONDITION_SATISFIED;
+    }
+
+    void AsyncDownload::wait() const
+    {
+        if (not valid())
+            return;
+
+        auto& slot = _ring.lock()->_slots.at(_slot);
+        if (slot.fence == nullptr)
+            return;
+
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+
+    bool AsyncDownload::get(Image& image) const
+    {
+        if (not valid())
+        {
+            std::cerr << "[WARNING] In AsyncDownload::get: Download is no longer available, its buffer was reused or its owner was destroyed." << std::endl;
+            return false;
+        }
+
+        wait();
+
+        auto& slot = _ring.lock()->_slots.at(_slot);
+        const size_t row_size = slot.size.x * 4;
+
+        if (image.get_size() != slot.size)
+            image.create(slot.size.x, slot.size.y);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer_id);
+        auto* mapped = static_cast<const uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, row_size * slot.size.y, GL_MAP_READ_BIT));
+
+        if (mapped == nullptr)
+        {
+            std::cerr << "[WARNING] In AsyncDownload::get: Unable to map pixel buffer." << std::endl;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            return false;
+        }
+
+        // image is RGBA32 like the buffer, so at most the row order differs
+        SDL_Surface* surface = image;
+        auto* pixels = static_cast<uint8_t*>(surface->pixels);
+
+        for (size_t y = 0; y < slot.size.y; ++y)
+        {
+            auto source_row = slot.flip_rows ? slot.size.y - 1 - y : y;
+            std::memcpy(pixels + y * surface->pitch, mapped + source_row * row_size, row_size);
+        }
+
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return true;
+    }
+
+    Vector2ui AsyncDownload::get_size() const
+    {
+        if (not valid())
+            return {0, 0};
+
+        return _ring.lock()->_slots.at(_slot).size;
+    }
+
+    // PIXEL BUFFER RING
+
+    PixelBufferRing::PixelBufferRing()
+    {}
+
+    PixelBufferRing::~PixelBufferRing()
+    {
+        for (auto& slot : _slots)
+        {
+            if (slot.fence != nullptr)
+                glDeleteSync(slot.fence);
+
+            if (slot.buffer_id != 0)
+                glDeleteBuffers(1, &slot.buffer_id);
+        }
+    }
+
+    AsyncDownload PixelBufferRing::read(GLNativeHandle framebuffer, GLenum read_buffer, Vector2ui size, bool flip_rows)
+    {
+        _current_slot = (_current_slot + 1) % n_buffers;
+        auto& slot = _slots.at(_current_slot);
+
+        // invalidates the handle that still points to this slot
+        slot.generation += 1;
+        slot.size = size;
+        slot.flip_rows = flip_rows;
+
+        if (slot.fence != nullptr)
+        {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+
+        if (slot.buffer_id == 0)
+            glGenBuffers(1, &slot.buffer_id);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer_id);
+
+        const size_t n_bytes = size.x * size.y * 4;
+        if (slot.capacity < n_bytes)
+        {
+            glBufferData(GL_PIXEL_PACK_BUFFER, n_bytes, nullptr, GL_STREAM_READ);
+            slot.capacity = n_bytes;
+        }
+
+        GLint previous_framebuffer;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glReadBuffer(read_buffer);
+
+        // with a pack buffer bound, the pointer is an offset and the call returns without waiting for the gpu
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+        glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, (void*) 0);
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, previous_framebuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        return AsyncDownload(weak_from_this(), _current_slot, slot.generation);
+    }
+}
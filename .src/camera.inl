@@ -68,6 +68,11 @@ namespace rat
         update();
     }
 
+    float Camera::get_zoom() const
+    {
+        return _zoom;
+    }
+
     void Camera::zoom_in(float factor)
     {
         _zoom *= (1 + factor);
@@ -13,7 +13,7 @@ namespace rat
     
     HSVA::HSVA(RGBA in)
     {
-        auto rgb_to_hsv = [alpha = this->a](auto r, auto g, auto b) -> glm::vec<4, float>
+        auto rgb_to_hsv = [alpha = in.a](auto r, auto g, auto b) -> glm::vec<4, float>
         {
             float h, s, v;
 
@@ -53,7 +53,8 @@ namespace rat
             if (h < 0)
                 h += 360;
 
-            return HSVA(h / 360.f, s, v, alpha);
+            // not HSVA, its conversion operator would turn it back into rgb
+            return glm::vec<4, float>(h / 360.f, s, v, alpha);
         };
         
         auto out = rgb_to_hsv(in.r, in.g, in.b);
@@ -0,0 +1,261 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/26/22 by clem (mail@clemens-cords.com)
+//
+
+#include <thread>
+#include <algorithm>
+
+#include <include/opengl_common.hpp>
+#include <include/texture.hpp>
+#include <include/profiler.hpp>
+#include <include/frame_stats.hpp>
+
+namespace rat
+{
+    void Renderable::record(CommandBuffer& buffer, Shader& shader, Transform transform) const
+    {
+        buffer.record_render_call(this, shader, transform);
+    }
+
+    CommandBuffer::CommandBuffer(const RenderTarget* target)
+        : _target(target), _global_transform(target->get_global_transform()), _viewport_size(get_viewport_size())
+    {}
+
+    void CommandBuffer::record(const Renderable* renderable, Shader& shader, Transform transform)
+    {
+        if (renderable == nullptr)
+            return;
+
+        renderable->record(*this, shader, transform);
+    }
+
+    void CommandBuffer::record_render_call(const Renderable* renderable, Shader& shader, Transform transform)
+    {
+        auto command = Command();
+        command.renderable = renderable;
+        command.transform = transform;
+        command.shader = &shader;
+        _commands.push_back(command);
+    }
+
+    bool CommandBuffer::is_culled(size_t offset) const
+    {
+        if (not _culling_enabled or offset >= _positions.size())
+            return false;
+
+        float min_x = infinity<float>,
+              min_y = infinity<float>;
+
+        float max_x = negative_infinity<float>,
+              max_y = negative_infinity<float>;
+
+        for (size_t i = offset; i + 2 < _positions.size(); i += 3)
+        {
+            min_x = std::min(min_x, _positions[i]);
+            max_x = std::max(max_x, _positions[i]);
+            min_y = std::min(min_y, _positions[i+1]);
+            max_y = std::max(max_y, _positions[i+1]);
+        }
+
+        return max_x < -1 or min_x > 1 or max_y < -1 or min_y > 1;
+    }
+
+    void CommandBuffer::initialize_buffers()
+    {
+        if (_buffers_initialized)
+            return;
+
+        glGenVertexArrays(1, &_vertex_array_id);
+        glGenBuffers(1, &_element_buffer_id);
+
+        _position_buffer = std::make_unique<StreamingBuffer>(GL_ARRAY_BUFFER);
+        _color_buffer = std::make_unique<StreamingBuffer>(GL_ARRAY_BUFFER);
+        _texture_coordinate_buffer = std::make_unique<StreamingBuffer>(GL_ARRAY_BUFFER);
+
+        _buffers_initialized = true;
+    }
+
+    void CommandBuffer::submit() const
+    {
+        _n_draw_calls = 0;
+        if (_commands.empty())
+            return;
+
+        PROFILE_SCOPE("command_buffer.submit");
+        PROFILE_GPU_SCOPE("command_buffer.submit");
+
+        initialize_buffers();
+
+        // upload vertex data of all commands at once, batches only differ in their index range
+        glBindVertexArray(_vertex_array_id);
+
+        // streaming buffers bind themselves on write
+        auto offset = _position_buffer->write(_positions.data(), _positions.size() * sizeof(float));
+        glVertexAttribPointer(Shader::get_vertex_position_location(), 3, GL_FLOAT, GL_FALSE, 0, (void*) offset);
+        glEnableVertexAttribArray(Shader::get_vertex_position_location());
+
+        offset = _color_buffer->write(_colors.data(), _colors.size() * sizeof(float));
+        glVertexAttribPointer(Shader::get_vertex_color_location(), 4, GL_FLOAT, GL_FALSE, 0, (void*) offset);
+        glEnableVertexAttribArray(Shader::get_vertex_color_location());
+
+        offset = _texture_coordinate_buffer->write(_texture_coordinates.data(), _texture_coordinates.size() * sizeof(float));
+        glVertexAttribPointer(Shader::get_vertex_texture_coordinate_location(), 2, GL_FLOAT, GL_FALSE, 0, (void*) offset);
+        glEnableVertexAttribArray(Shader::get_vertex_texture_coordinate_location());
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        size_t batch_begin = 0;
+        for (size_t i = 0; i < _commands.size(); ++i)
+        {
+            auto& command = _commands.at(i);
+            if (command.renderable != nullptr)
+            {
+                draw_batch(batch_begin, i);
+                batch_begin = i + 1;
+
+                _target->render(command.renderable, *command.shader, command.transform);
+                _n_draw_calls += 1;
+                continue;
+            }
+
+            auto& first = _commands.at(batch_begin);
+            if (first.shader != command.shader or first.texture != command.texture)
+            {
+                draw_batch(batch_begin, i);
+                batch_begin = i;
+            }
+        }
+
+        draw_batch(batch_begin, _commands.size());
+
+        _position_buffer->fence();
+        _color_buffer->fence();
+        _texture_coordinate_buffer->fence();
+    }
+
+    void CommandBuffer::draw_batch(size_t begin, size_t end) const
+    {
+        if (begin >= end)
+            return;
+
+        _batch_indices.clear();
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto& command = _commands.at(i);
+            for (auto index : *command.indices)
+                _batch_indices.push_back(command.vertex_offset + index);
+        }
+
+        if (_batch_indices.empty())
+            return;
+
+        auto& first = _commands.at(begin);
+        auto* texture = first.texture;
+
+        GLNativeHandle program_id = first.shader->get_program_id();
+        glUseProgram(program_id);
+        detail::count_program_use(program_id);
+        glBindVertexArray(_vertex_array_id);
+
+        if (texture != nullptr)
+            texture->bind();
+
+        glUniform1i(first.shader->get_fragment_texture_set_location(), texture != nullptr);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _element_buffer_id);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, _batch_indices.size() * sizeof(uint32_t), _batch_indices.data(), GL_STREAM_DRAW);
+        glDrawElements(GL_TRIANGLES, _batch_indices.size(), GL_UNSIGNED_INT, (void*) 0);
+        detail::count_buffer_upload(_batch_indices.size() * sizeof(uint32_t));
+        detail::count_draw_call(_batch_indices.size());
+        _n_draw_calls += 1;
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        if (texture != nullptr)
+            texture->unbind();
+    }
+
+    size_t CommandBuffer::get_n_draw_calls() const
+    {
+        return _n_draw_calls;
+    }
+
+    void CommandBuffer::clear()
+    {
+        _commands.clear();
+        _positions.clear();
+        _colors.clear();
+        _texture_coordinates.clear();
+        _n_culled = 0;
+    }
+
+    size_t CommandBuffer::get_n_commands() const
+    {
+        return _commands.size();
+    }
+
+    size_t CommandBuffer::get_n_culled() const
+    {
+        return _n_culled;
+    }
+
+    void CommandBuffer::set_culling_enabled(bool b)
+    {
+        _culling_enabled = b;
+    }
+
+    bool CommandBuffer::get_culling_enabled() const
+    {
+        return _culling_enabled;
+    }
+
+    Transform CommandBuffer::get_global_transform() const
+    {
+        return _global_transform;
+    }
+
+    Transform CommandBuffer::combine_transforms(Transform transform) const
+    {
+        return _target->combine_transforms(transform, _global_transform);
+    }
+
+    Vector2f CommandBuffer::get_viewport() const
+    {
+        return _viewport_size;
+    }
+
+    void render_in_parallel(const RenderTarget* target, const std::vector<const Renderable*>& renderables, size_t n_threads, Shader& shader)
+    {
+        n_threads = std::clamp<size_t>(n_threads, 1, std::max<size_t>(renderables.size(), 1));
+
+        // buffers are created on the render thread, as they query the viewport
+        auto buffers = std::vector<CommandBuffer>(n_threads, CommandBuffer(target));
+        const size_t slice_size = (renderables.size() + n_threads - 1) / n_threads;
+
+        auto record_slice = [&](size_t thread_i)
+        {
+            auto begin = std::min(thread_i * slice_size, renderables.size());
+            auto end = std::min(begin + slice_size, renderables.size());
+
+            for (size_t i = begin; i < end; ++i)
+                buffers.at(thread_i).record(renderables.at(i), shader);
+        };
+
+        auto threads = std::vector<std::thread>();
+        threads.reserve(n_threads - 1);
+
+        for (size_t i = 1; i < n_threads; ++i)
+            threads.emplace_back(record_slice, i);
+
+        record_slice(0);
+
+        for (auto& thread : threads)
+            thread.join();
+
+        for (auto& buffer : buffers)
+            buffer.submit();
+    }
+}
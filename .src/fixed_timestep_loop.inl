@@ -0,0 +1,111 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/27/22 by clem (mail@clemens-cords.com)
+//
+
+#include <algorithm>
+
+namespace rat
+{
+    FixedTimestepLoop::FixedTimestepLoop(Time timestep, size_t max_steps_per_frame)
+        : _timestep_ns(std::max<size_t>(timestep.as_nanoseconds(), 1)),
+          _max_steps_per_frame(std::max<size_t>(max_steps_per_frame, 1))
+    {}
+
+    void FixedTimestepLoop::set_update_function(std::function<void(Time)> f)
+    {
+        _update = f;
+    }
+
+    void FixedTimestepLoop::set_render_function(std::function<void(float)> f)
+    {
+        _render = f;
+    }
+
+    size_t FixedTimestepLoop::step()
+    {
+        _accumulator_ns += _clock.restart().as_nanoseconds();
+
+        size_t n = 0;
+        while (_accumulator_ns >= _timestep_ns and n < _max_steps_per_frame)
+        {
+            _update(nanoseconds(_timestep_ns));
+            _accumulator_ns -= _timestep_ns;
+            n += 1;
+        }
+
+        // simulation can't keep up, drop the backlog but keep the fractional remainder
+        if (_accumulator_ns >= _timestep_ns)
+        {
+            _n_dropped_steps += _accumulator_ns / _timestep_ns;
+            _accumulator_ns %= _timestep_ns;
+        }
+
+        _n_steps += n;
+        _n_steps_last_frame = n;
+        _average_steps_per_frame += _average_weight * (float(n) - _average_steps_per_frame);
+
+        _alpha = float(_accumulator_ns) / float(_timestep_ns);
+        _render(_alpha);
+
+        return n;
+    }
+
+    void FixedTimestepLoop::reset()
+    {
+        _clock.restart();
+        _accumulator_ns = 0;
+        _alpha = 0;
+    }
+
+    void FixedTimestepLoop::set_timestep(Time timestep)
+    {
+        _timestep_ns = std::max<size_t>(timestep.as_nanoseconds(), 1);
+    }
+
+    Time FixedTimestepLoop::get_timestep() const
+    {
+        return nanoseconds(_timestep_ns);
+    }
+
+    void FixedTimestepLoop::set_max_steps_per_frame(size_t n)
+    {
+        _max_steps_per_frame = std::max<size_t>(n, 1);
+    }
+
+    size_t FixedTimestepLoop::get_max_steps_per_frame() const
+    {
+        return _max_steps_per_frame;
+    }
+
+    float FixedTimestepLoop::get_alpha() const
+    {
+        return _alpha;
+    }
+
+    size_t FixedTimestepLoop::get_n_steps_last_frame() const
+    {
+        return _n_steps_last_frame;
+    }
+
+    float FixedTimestepLoop::get_average_steps_per_frame() const
+    {
+        return _average_steps_per_frame;
+    }
+
+    size_t FixedTimestepLoop::get_n_steps() const
+    {
+        return _n_steps;
+    }
+
+    size_t FixedTimestepLoop::get_n_dropped_steps() const
+    {
+        return _n_dropped_steps;
+    }
+
+    template<typename T>
+    T interpolate(const T& previous, const T& current, float alpha)
+    {
+        return previous + (current - previous) * alpha;
+    }
+}
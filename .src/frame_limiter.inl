@@ -0,0 +1,107 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/27/22 by clem (mail@clemens-cords.com)
+//
+
+#include <thread>
+
+namespace rat
+{
+    FrameLimiter::FrameLimiter(float target_frame_rate)
+    {
+        set_target_frame_rate(target_frame_rate);
+    }
+
+    void FrameLimiter::set_target_frame_rate(float fps)
+    {
+        if (fps <= 0)
+            _frame_duration = clock::duration::zero();
+        else
+            _frame_duration = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / fps));
+
+        _deadline = _frame_start + _frame_duration;
+    }
+
+    float FrameLimiter::get_target_frame_rate() const
+    {
+        if (_frame_duration == clock::duration::zero())
+            return 0;
+
+        return 1.0 / std::chrono::duration<double>(_frame_duration).count();
+    }
+
+    void FrameLimiter::set_spin_duration(Time time)
+    {
+        _spin_duration = std::chrono::nanoseconds(time.as_nanoseconds());
+    }
+
+    Time FrameLimiter::wait()
+    {
+        auto now = clock::now();
+        _last_work_duration = now - _frame_start;
+
+        if (_frame_duration != clock::duration::zero())
+        {
+            // sleep in chunks, as a single sleep may overshoot by more than the spin duration
+            while (_deadline - now > _spin_duration)
+            {
+                std::this_thread::sleep_for(_deadline - now - _spin_duration);
+                now = clock::now();
+            }
+
+            while (now < _deadline)
+            {
+                std::this_thread::yield();
+                now = clock::now();
+            }
+
+            // more than a frame behind: skip the missed deadlines instead of rushing to catch up
+            _deadline += _frame_duration;
+            if (_deadline < now)
+                _deadline = now + _frame_duration;
+        }
+
+        return end_frame(now);
+    }
+
+    Time FrameLimiter::skip()
+    {
+        auto now = clock::now();
+        _last_work_duration = now - _frame_start;
+        _deadline = now + _frame_duration;
+
+        return end_frame(now);
+    }
+
+    Time FrameLimiter::end_frame(clock::time_point now)
+    {
+        _last_frame_duration = now - _frame_start;
+        _frame_start = now;
+
+        const float seconds = std::chrono::duration<float>(_last_frame_duration).count();
+        if (_average_frame_duration == 0)
+            _average_frame_duration = seconds;
+        else
+            _average_frame_duration += _average_weight * (seconds - _average_frame_duration);
+
+        return nanoseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(_last_frame_duration).count());
+    }
+
+    Time FrameLimiter::get_frame_duration() const
+    {
+        return nanoseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(_last_frame_duration).count());
+    }
+
+    Time FrameLimiter::get_work_duration() const
+    {
+        return nanoseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(_last_work_duration).count());
+    }
+
+    float FrameLimiter::get_average_frame_rate() const
+    {
+        if (_average_frame_duration <= 0)
+            return 0;
+
+        return 1 / _average_frame_duration;
+    }
+}
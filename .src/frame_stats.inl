@@ -0,0 +1,46 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/28/22 by clem (mail@clemens-cords.com)
+//
+
+namespace rat
+{
+    void FrameStats::reset()
+    {
+        n_draw_calls = 0;
+        n_vertices = 0;
+        n_buffer_uploads = 0;
+        n_bytes_uploaded = 0;
+        n_texture_binds = 0;
+        n_program_switches = 0;
+    }
+
+    namespace detail
+    {
+        void count_draw_call(size_t n_vertices)
+        {
+            current_frame_stats.n_draw_calls += 1;
+            current_frame_stats.n_vertices += n_vertices;
+        }
+
+        void count_buffer_upload(size_t n_bytes)
+        {
+            current_frame_stats.n_buffer_uploads += 1;
+            current_frame_stats.n_bytes_uploaded += n_bytes;
+        }
+
+        void count_texture_bind()
+        {
+            current_frame_stats.n_texture_binds += 1;
+        }
+
+        void count_program_use(GLNativeHandle program_id)
+        {
+            if (program_id == last_used_program)
+                return;
+
+            current_frame_stats.n_program_switches += 1;
+            last_used_program = program_id;
+        }
+    }
+}
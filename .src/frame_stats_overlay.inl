@@ -0,0 +1,61 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/28/22 by clem (mail@clemens-cords.com)
+//
+
+#include <sstream>
+#include <iomanip>
+
+namespace rat
+{
+    FrameStatsOverlay::FrameStatsOverlay(size_t font_size, const std::string& font_id, const std::string& font_path)
+        : _text(font_size, font_id, font_path)
+    {}
+
+    void FrameStatsOverlay::update(RenderTarget& target, const FrameStats& stats, const FrameLimiter* limiter)
+    {
+        if (_created and _refresh_clock.elapsed() < _refresh_interval)
+            return;
+
+        _refresh_clock.restart();
+
+        auto str = std::stringstream();
+        str << std::fixed << std::setprecision(1);
+
+        if (limiter != nullptr)
+            str << "fps: " << limiter->get_average_frame_rate() << " (" << limiter->get_frame_duration().as_milliseconds() << " ms)\n";
+
+        str << "draw calls: " << stats.n_draw_calls << "\n"
+            << "vertices: " << stats.n_vertices << "\n"
+            << "uploads: " << stats.n_buffer_uploads << " (" << stats.n_bytes_uploaded / 1024.f << " kb)\n"
+            << "texture binds: " << stats.n_texture_binds << "\n"
+            << "program switches: " << stats.n_program_switches;
+
+        _text.create(target, _position, str.str());
+        _created = true;
+    }
+
+    void FrameStatsOverlay::set_refresh_interval(Time interval)
+    {
+        _refresh_interval = interval;
+    }
+
+    void FrameStatsOverlay::set_position(Vector2f position)
+    {
+        _position = position;
+        if (_created)
+            _text.set_top_left(position);
+    }
+
+    void FrameStatsOverlay::render(const RenderTarget* target, Shader& shader, Transform transform) const
+    {
+        if (_created)
+            _text.render(target, shader, transform);
+    }
+
+    void FrameStatsOverlay::record(CommandBuffer& buffer, Shader& shader, Transform transform) const
+    {
+        if (_created)
+            _text.record(buffer, shader, transform);
+    }
+}
@@ -3,6 +3,20 @@
 // Created on 6/30/22 by clem (mail@clemens-cords.com)
 //
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+// avx2 kernels are compiled with a target attribute and selected at runtime, so no -mavx2 is needed
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__))
+    #include <immintrin.h>
+    #define MOUSETRAP_AVX2_DISPATCH
+#endif
+
 namespace rat
 {
     Image::Image()
@@ -10,7 +24,8 @@ namespace rat
     
     Image::~Image()
     {
-        SDL_FreeSurface(_data);
+        if (_data != nullptr)
+            SDL_FreeSurface(_data);
     }
 
     Image::operator SDL_Surface*()
@@ -20,53 +35,67 @@ namespace rat
 
     RGBA Image::bit_to_color(uint32_t in)
     {
-        RGBA out;
-        uint8_t r, g, b, a;
+        // format is fixed, so the bytes can be read directly instead of going through SDL_GetRGBA
+        std::array<uint8_t, 4> bytes;
+        std::memcpy(bytes.data(), &in, 4);
 
-        SDL_GetRGBA(in, _data->format, &r, &g, &b, &a);
-
-        out.r = r / 255.f;
-        out.g = g / 255.f;
-        out.b = b / 255.f;
-        out.a = a / 255.f;
-
-        return out;
+        const float factor = 1 / 255.f;
+        return RGBA(bytes[0] * factor, bytes[1] * factor, bytes[2] * factor, bytes[3] * factor);
     }
 
     uint32_t Image::color_to_bit(RGBA in)
     {
-        return SDL_MapRGBA(_data->format, in.r * 255, in.g * 255, in.b * 255, in.a * 255);
+        auto to_byte = [](float x) -> uint8_t {
+            return std::clamp(x, 0.f, 1.f) * 255.f + 0.5f;
+        };
+
+        std::array<uint8_t, 4> bytes = {to_byte(in.r), to_byte(in.g), to_byte(in.b), to_byte(in.a)};
+
+        uint32_t out;
+        std::memcpy(&out, bytes.data(), 4);
+        return out;
     }
 
     size_t Image::to_linear_index(size_t x, size_t y) const
     {
-        return y * get_size().x + x;
+        return y * (_data->pitch / sizeof(Value_t)) + x;
     }
 
     Vector2ui Image::get_size() const
     {
+        if (_data == nullptr)
+            return {0, 0};
+
         return {_data->w, _data->h};
     }
 
     void Image::create(size_t width, size_t height, RGBA color)
     {
-        _data = SDL_CreateRGBSurface(0, width, height, 32, r_mask, g_mask, b_mask, a_mask);
-        
-        auto value = color_to_bit(color);
-        for (size_t i = 0; i < get_size().x; ++i)
-            for (size_t j = 0; j < get_size().y; ++j)
-                ((uint32_t*) _data->pixels)[to_linear_index(i, j)] = value;
+        if (_data != nullptr)
+            SDL_FreeSurface(_data);
+
+        _data = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+        fill(color);
     }
 
     bool Image::load(const std::string &path)
     {
+        if (_data != nullptr)
+            SDL_FreeSurface(_data);
+
         _data = IMG_Load(path.c_str());
 
+        if (_data == nullptr)
+        {
+            std::cerr << "[WARNING] In Image::load: Unable to load image at " << path << ": " << IMG_GetError() << std::endl;
+            return false;
+        }
+
         if (_data->format->format != SDL_PIXELFORMAT_RGBA32)
         {
-            auto* _temp = _data;
-            auto format = SDL_AllocFormat(SDL_PIXELFORMAT_RGBA32);
-            _data = SDL_ConvertSurfaceFormat(_temp, format->format, 0);
+            auto* temp = _data;
+            _data = SDL_ConvertSurfaceFormat(temp, SDL_PIXELFORMAT_RGBA32, 0);
+            SDL_FreeSurface(temp);
         }
 
         return (_data->w != 0 and _data->h != 0);
@@ -87,6 +116,7 @@ namespace rat
     Image::Iterator<is_const> &Image::Iterator<is_const>::operator=(RGBA in) requires (not is_const)
     {
         ((uint32_t*) _image->_data->pixels)[_image->to_linear_index(_x, _y)] = _image->color_to_bit(in);
+        return *this;
     }
 
     template<bool is_const>
@@ -198,4 +228,237 @@ namespace rat
     {
         return (uint32_t*) _data->pixels;
     }
+
+    const uint32_t* Image::data() const
+    {
+        return (const uint32_t*) _data->pixels;
+    }
+
+    std::span<uint32_t> Image::get_row(size_t y)
+    {
+        return std::span<uint32_t>(data() + y * get_pitch(), _data->w);
+    }
+
+    std::span<const uint32_t> Image::get_row(size_t y) const
+    {
+        return std::span<const uint32_t>(data() + y * get_pitch(), _data->w);
+    }
+
+    size_t Image::get_pitch() const
+    {
+        if (_data == nullptr)
+            return 0;
+
+        return _data->pitch / sizeof(Value_t);
+    }
+
+    void Image::fill(RGBA color)
+    {
+        if (_data == nullptr)
+            return;
+
+        auto value = color_to_bit(color);
+        for (size_t y = 0; y < size_t(_data->h); ++y)
+        {
+            auto row = get_row(y);
+            std::fill(row.begin(), row.end(), value);
+        }
+    }
+
+    void Image::blit(const Image& source, Vector2i top_left)
+    {
+        if (_data == nullptr or source._data == nullptr)
+            return;
+
+        // clip to both images
+        const int64_t x_begin = std::max<int64_t>(0, -top_left.x),
+                      y_begin = std::max<int64_t>(0, -top_left.y),
+                      x_end = std::min<int64_t>(source._data->w, _data->w - top_left.x),
+                      y_end = std::min<int64_t>(source._data->h, _data->h - top_left.y);
+
+        if (x_begin >= x_end or y_begin >= y_end)
+            return;
+
+        for (int64_t y = y_begin; y < y_end; ++y)
+        {
+            auto from = source.get_row(y);
+            auto to = get_row(y + top_left.y);
+            std::memcpy(to.data() + x_begin + top_left.x, from.data() + x_begin, (x_end - x_begin) * sizeof(Value_t));
+        }
+    }
+
+    namespace detail
+    {
+        inline bool cpu_has_avx2()
+        {
+            #if defined(MOUSETRAP_AVX2_DISPATCH)
+            static const bool out = __builtin_cpu_supports("avx2");
+            return out;
+            #else
+            return false;
+            #endif
+        }
+
+        // x * a / 255 for x, a in [0, 255], rounded, exact for x * 255
+        inline uint8_t multiply_255(uint32_t x, uint32_t a)
+        {
+            uint32_t t = x * a + 128;
+            return (t + (t >> 8)) >> 8;
+        }
+
+        #if defined(MOUSETRAP_AVX2_DISPATCH)
+        // per 16-bit lane: multiply with the pixels alpha, alpha itself with 255
+        __attribute__((target("avx2")))
+        inline __m256i multiply_alpha_avx2(__m256i x)
+        {
+            const __m256i round = _mm256_set1_epi16(128),
+                          alpha_lanes = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0),
+                          alpha_factor = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+
+            __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, 0xFF), 0xFF);
+            a = _mm256_or_si256(_mm256_andnot_si256(alpha_lanes, a), alpha_factor);
+
+            __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(x, a), round);
+            return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+        }
+
+        // same as the sse2 path on 8 pixels at a time, unpack and pack stay within 128-bit lanes so the order holds
+        // returns number of pixels processed
+        __attribute__((target("avx2")))
+        inline size_t premultiply_alpha_avx2(uint8_t* bytes, size_t n_pixels)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+
+            size_t i = 0;
+            for (; i + 8 <= n_pixels; i += 8)
+            {
+                auto* address = reinterpret_cast<__m256i*>(bytes + i * 4);
+                __m256i pixels = _mm256_loadu_si256(address);
+                __m256i low = multiply_alpha_avx2(_mm256_unpacklo_epi8(pixels, zero)),
+                        high = multiply_alpha_avx2(_mm256_unpackhi_epi8(pixels, zero));
+
+                _mm256_storeu_si256(address, _mm256_packus_epi16(low, high));
+            }
+
+            return i;
+        }
+        #endif
+
+        inline void premultiply_alpha(uint8_t* bytes, size_t n_pixels)
+        {
+            size_t i = 0;
+
+            #if defined(MOUSETRAP_AVX2_DISPATCH)
+            if (cpu_has_avx2())
+                i = premultiply_alpha_avx2(bytes, n_pixels);
+            #endif
+
+            #if defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128(),
+                          round = _mm_set1_epi16(128),
+                          alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0),
+                          alpha_factor = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+            // per 16-bit lane: multiply with the pixels alpha, alpha itself with 255
+            auto multiply = [&](__m128i x) {
+                __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xFF), 0xFF);
+                a = _mm_or_si128(_mm_andnot_si128(alpha_lanes, a), alpha_factor);
+
+                __m128i t = _mm_add_epi16(_mm_mullo_epi16(x, a), round);
+                return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+            };
+
+            for (; i + 4 <= n_pixels; i += 4)
+            {
+                auto* address = reinterpret_cast<__m128i*>(bytes + i * 4);
+                __m128i pixels = _mm_loadu_si128(address);
+                __m128i low = multiply(_mm_unpacklo_epi8(pixels, zero)),
+                        high = multiply(_mm_unpackhi_epi8(pixels, zero));
+
+                _mm_storeu_si128(address, _mm_packus_epi16(low, high));
+            }
+            #endif
+
+            for (; i < n_pixels; ++i)
+            {
+                uint8_t* pixel = bytes + i * 4;
+                pixel[0] = multiply_255(pixel[0], pixel[3]);
+                pixel[1] = multiply_255(pixel[1], pixel[3]);
+                pixel[2] = multiply_255(pixel[2], pixel[3]);
+            }
+        }
+
+        // rgba <-> bgra, the same operation in both directions
+        inline void swap_red_blue(const uint32_t* from, uint32_t* to, size_t n_pixels)
+        {
+            size_t i = 0;
+
+            #if defined(__SSE2__)
+            const __m128i green_alpha = _mm_set1_epi32(0xFF00FF00),
+                          low_byte = _mm_set1_epi32(0x000000FF),
+                          third_byte = _mm_set1_epi32(0x00FF0000);
+
+            for (; i + 4 <= n_pixels; i += 4)
+            {
+                __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+                __m128i out = _mm_or_si128(
+                    _mm_and_si128(pixels, green_alpha),
+                    _mm_or_si128(
+                        _mm_and_si128(_mm_slli_epi32(pixels, 16), third_byte),
+                        _mm_and_si128(_mm_srli_epi32(pixels, 16), low_byte)
+                    )
+                );
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), out);
+            }
+            #endif
+
+            for (; i < n_pixels; ++i)
+            {
+                uint32_t x = from[i];
+                to[i] = (x & 0xFF00FF00) | ((x << 16) & 0x00FF0000) | ((x >> 16) & 0x000000FF);
+            }
+        }
+    }
+
+    void Image::premultiply_alpha()
+    {
+        if (_data == nullptr)
+            return;
+
+        for (size_t y = 0; y < size_t(_data->h); ++y)
+            detail::premultiply_alpha(reinterpret_cast<uint8_t*>(get_row(y).data()), _data->w);
+    }
+
+    bool Image::convert_to(uint32_t format, void* destination, size_t destination_pitch) const
+    {
+        if (_data == nullptr)
+            return false;
+
+        const size_t width = _data->w,
+                     height = _data->h;
+
+        if (format == SDL_PIXELFORMAT_RGBA32)
+        {
+            for (size_t y = 0; y < height; ++y)
+                std::memcpy(static_cast<uint8_t*>(destination) + y * destination_pitch, get_row(y).data(), width * sizeof(Value_t));
+
+            return true;
+        }
+
+        if (format == SDL_PIXELFORMAT_BGRA32)
+        {
+            for (size_t y = 0; y < height; ++y)
+                detail::swap_red_blue(get_row(y).data(), reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(destination) + y * destination_pitch), width);
+
+            return true;
+        }
+
+        if (SDL_ConvertPixels(width, height, SDL_PIXELFORMAT_RGBA32, _data->pixels, _data->pitch, format, destination, destination_pitch) != 0)
+        {
+            std::cerr << "[WARNING] In Image::convert_to: Unable to convert pixels: " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
 }
\ No newline at end of file
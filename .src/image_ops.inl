@@ -0,0 +1,394 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/31/22 by clem (mail@clemens-cords.com)
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <include/colors.hpp>
+
+namespace rat
+{
+    namespace detail
+    {
+        inline void for_each_row_chunk(ThreadPool* pool, size_t n_rows, const std::function<void(size_t, size_t)>& function)
+        {
+            if (pool == nullptr or n_rows < 2)
+                function(0, n_rows);
+            else
+                pool->parallel_for(n_rows, function);
+        }
+
+        // 24-bit fixed point reciprocal, sum * reciprocal >> 24 is sum / n rounded
+        inline uint64_t fixed_reciprocal(size_t n)
+        {
+            return ((uint64_t(1) << 24) + n / 2) / n;
+        }
+
+        inline uint8_t fixed_divide(uint64_t sum, uint64_t reciprocal)
+        {
+            return std::min<uint64_t>((sum * reciprocal + (uint64_t(1) << 23)) >> 24, 255);
+        }
+
+        // horizontal sliding window over one row of width pixels, 4 bytes each
+        inline void box_blur_row(const uint8_t* in, uint8_t* out, size_t width, size_t radius)
+        {
+            const int64_t last = width - 1;
+            const auto reciprocal = fixed_reciprocal(2 * radius + 1);
+
+            auto clamp = [last](int64_t x) { return std::clamp<int64_t>(x, 0, last); };
+
+            std::array<uint32_t, 4> sum = {0, 0, 0, 0};
+            for (int64_t x = -int64_t(radius); x <= int64_t(radius); ++x)
+                for (size_t c = 0; c < 4; ++c)
+                    sum[c] += in[clamp(x) * 4 + c];
+
+            for (int64_t x = 0; x <= last; ++x)
+            {
+                const auto* add = in + clamp(x + radius + 1) * 4;
+                const auto* remove = in + clamp(x - radius) * 4;
+
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    out[x * 4 + c] = fixed_divide(sum[c], reciprocal);
+                    sum[c] += add[c];
+                    sum[c] -= remove[c];
+                }
+            }
+        }
+
+        // vertical sliding window over all rows of a byte range, whole rows are added at once so it vectorizes
+        inline void box_blur_columns(const uint8_t* in, size_t in_pitch, uint8_t* out, size_t out_pitch, size_t n_bytes, size_t height, size_t radius)
+        {
+            const int64_t last = height - 1;
+            const auto reciprocal = fixed_reciprocal(2 * radius + 1);
+
+            auto row = [&](int64_t y) { return in + std::clamp<int64_t>(y, 0, last) * in_pitch; };
+
+            auto sum = std::vector<uint32_t>(n_bytes, 0);
+            for (int64_t y = -int64_t(radius); y <= int64_t(radius); ++y)
+            {
+                const auto* source = row(y);
+                for (size_t i = 0; i < n_bytes; ++i)
+                    sum[i] += source[i];
+            }
+
+            for (int64_t y = 0; y <= last; ++y)
+            {
+                auto* destination = out + y * out_pitch;
+                for (size_t i = 0; i < n_bytes; ++i)
+                    destination[i] = fixed_divide(sum[i], reciprocal);
+
+                const auto* add = row(y + radius + 1);
+                const auto* remove = row(y - radius);
+                for (size_t i = 0; i < n_bytes; ++i)
+                    sum[i] += add[i] - remove[i];
+            }
+        }
+
+        class ResizeContribution
+        {
+            public:
+                size_t begin;
+                std::vector<float> weights;
+        };
+
+        // for each output pixel, the range of source pixels and their normalized weights
+        inline std::vector<ResizeContribution> compute_resize_contributions(size_t in_size, size_t out_size, ResizeFilter filter)
+        {
+            auto triangle = [](float x) -> float {
+                return std::max(0.f, 1.f - std::fabs(x));
+            };
+
+            auto lanczos = [](float x) -> float {
+                if (x == 0)
+                    return 1;
+
+                if (std::fabs(x) >= 3)
+                    return 0;
+
+                const float pi_x = float(M_PI) * x;
+                return 3 * std::sin(pi_x) * std::sin(pi_x / 3) / (pi_x * pi_x);
+            };
+
+            const float support = filter == ResizeFilter::LANCZOS ? 3 : 1,
+                        scale = float(in_size) / out_size,
+                        filter_scale = std::max(scale, 1.f), // widen the filter when shrinking, so nothing is skipped
+                        radius = support * filter_scale;
+
+            auto out = std::vector<ResizeContribution>(out_size);
+            for (size_t i = 0; i < out_size; ++i)
+            {
+                const float center = (i + 0.5f) * scale;
+                const int64_t begin = std::max<int64_t>(0, std::floor(center - radius)),
+                              end = std::min<int64_t>(in_size, std::ceil(center + radius));
+
+                auto& contribution = out.at(i);
+                contribution.begin = begin;
+
+                float sum = 0;
+                for (int64_t x = begin; x < end; ++x)
+                {
+                    float distance = (x + 0.5f - center) / filter_scale;
+                    float weight = filter == ResizeFilter::LANCZOS ? lanczos(distance) : triangle(distance);
+                    contribution.weights.push_back(weight);
+                    sum += weight;
+                }
+
+                if (sum == 0)
+                {
+                    contribution.begin = std::min<int64_t>(center, in_size - 1);
+                    contribution.weights = {1};
+                }
+                else
+                    for (auto& weight : contribution.weights)
+                        weight /= sum;
+            }
+
+            return out;
+        }
+
+        inline uint8_t float_to_byte(float x)
+        {
+            return std::clamp(x + 0.5f, 0.f, 255.f);
+        }
+
+        inline void swizzle_scalar(uint8_t* bytes, size_t n_pixels, const std::array<size_t, 4>& order)
+        {
+            for (size_t i = 0; i < n_pixels; ++i)
+            {
+                uint8_t* pixel = bytes + i * 4;
+                std::array<uint8_t, 4> in = {pixel[0], pixel[1], pixel[2], pixel[3]};
+                for (size_t c = 0; c < 4; ++c)
+                    pixel[c] = in[order[c]];
+            }
+        }
+
+        #if defined(MOUSETRAP_AVX2_DISPATCH)
+        // returns number of pixels processed
+        __attribute__((target("avx2")))
+        inline size_t swizzle_avx2(uint8_t* bytes, size_t n_pixels, const std::array<size_t, 4>& order)
+        {
+            // pshufb works within 128-bit lanes, each lane holds 4 whole pixels
+            std::array<int8_t, 32> indices;
+            for (size_t i = 0; i < 32; ++i)
+                indices[i] = (i % 16) / 4 * 4 + order[i % 4];
+
+            const __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices.data()));
+
+            size_t i = 0;
+            for (; i + 8 <= n_pixels; i += 8)
+            {
+                auto* address = reinterpret_cast<__m256i*>(bytes + i * 4);
+                _mm256_storeu_si256(address, _mm256_shuffle_epi8(_mm256_loadu_si256(address), mask));
+            }
+
+            return i;
+        }
+        #endif
+    }
+
+    void box_blur(Image& image, size_t radius, ThreadPool* pool)
+    {
+        SDL_Surface* surface = image;
+        if (surface == nullptr or radius == 0)
+            return;
+
+        const size_t width = surface->w,
+                     height = surface->h,
+                     pitch = surface->pitch,
+                     row_bytes = width * 4;
+
+        auto* pixels = static_cast<uint8_t*>(surface->pixels);
+        auto horizontal = std::vector<uint8_t>(row_bytes * height);
+
+        detail::for_each_row_chunk(pool, height, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; ++y)
+                detail::box_blur_row(pixels + y * pitch, horizontal.data() + y * row_bytes, width, radius);
+        });
+
+        // the vertical pass needs all rows, so it is split into column stripes instead, aligned to whole pixels
+        const size_t n_stripes = std::max<size_t>(1, (width + 63) / 64);
+        detail::for_each_row_chunk(pool, n_stripes, [&](size_t begin, size_t end) {
+            const size_t byte_begin = begin * 64 * 4,
+                         byte_end = std::min(end * 64 * 4, row_bytes);
+
+            detail::box_blur_columns(horizontal.data() + byte_begin, row_bytes, pixels + byte_begin, pitch, byte_end - byte_begin, height, radius);
+        });
+    }
+
+    void gaussian_blur(Image& image, float sigma, ThreadPool* pool)
+    {
+        if (sigma <= 0)
+            return;
+
+        // box widths whose three-fold convolution has the requested standard deviation, after P. Kovesi, "Fast
+        // Almost-Gaussian Filtering" (2010)
+        const int64_t n = 3;
+        const float variance = 12 * sigma * sigma;
+
+        int64_t lower = std::floor(std::sqrt(variance / n + 1));
+        if (lower % 2 == 0)
+            lower -= 1;
+
+        const int64_t upper = lower + 2;
+        const int64_t n_lower = std::round((variance - n * lower * lower - 4 * n * lower - 3 * n) / (-4.f * lower - 4));
+
+        for (int64_t i = 0; i < n; ++i)
+        {
+            const int64_t width = i < n_lower ? lower : upper;
+            box_blur(image, (width - 1) / 2, pool);
+        }
+    }
+
+    void resize(const Image& source, Image& destination, Vector2ui size, ResizeFilter filter, ThreadPool* pool)
+    {
+        SDL_Surface* in = const_cast<Image&>(source);
+        if (in == nullptr or size.x == 0 or size.y == 0)
+        {
+            std::cerr << "[WARNING] In resize: Source image or target size is empty." << std::endl;
+            return;
+        }
+
+        if (&source == &destination)
+        {
+            auto temp = Image();
+            resize(source, temp, size, filter, pool);
+            destination.create(size.x, size.y);
+            destination.blit(temp);
+            return;
+        }
+
+        const size_t in_width = in->w,
+                     in_height = in->h;
+
+        auto columns = detail::compute_resize_contributions(in_width, size.x, filter),
+             rows = detail::compute_resize_contributions(in_height, size.y, filter);
+
+        // horizontal pass into floats, so the vertical pass does not round twice
+        const size_t row_floats = size.x * 4;
+        auto horizontal = std::vector<float>(row_floats * in_height);
+
+        detail::for_each_row_chunk(pool, in_height, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; ++y)
+            {
+                const auto* from = static_cast<const uint8_t*>(in->pixels) + y * in->pitch;
+                auto* to = horizontal.data() + y * row_floats;
+
+                for (size_t x = 0; x < size.x; ++x)
+                {
+                    auto& contribution = columns.at(x);
+                    std::array<float, 4> sum = {0, 0, 0, 0};
+
+                    for (size_t i = 0; i < contribution.weights.size(); ++i)
+                    {
+                        const auto* pixel = from + (contribution.begin + i) * 4;
+                        const float weight = contribution.weights[i];
+                        for (size_t c = 0; c < 4; ++c)
+                            sum[c] += pixel[c] * weight;
+                    }
+
+                    std::copy(sum.begin(), sum.end(), to + x * 4);
+                }
+            }
+        });
+
+        destination.create(size.x, size.y);
+        SDL_Surface* out = destination;
+
+        detail::for_each_row_chunk(pool, size.y, [&](size_t begin, size_t end) {
+            auto sum = std::vector<float>(row_floats);
+            for (size_t y = begin; y < end; ++y)
+            {
+                auto& contribution = rows.at(y);
+                std::fill(sum.begin(), sum.end(), 0.f);
+
+                for (size_t i = 0; i < contribution.weights.size(); ++i)
+                {
+                    const auto* from = horizontal.data() + (contribution.begin + i) * row_floats;
+                    const float weight = contribution.weights[i];
+                    for (size_t j = 0; j < row_floats; ++j)
+                        sum[j] += from[j] * weight;
+                }
+
+                auto* to = static_cast<uint8_t*>(out->pixels) + y * out->pitch;
+                for (size_t j = 0; j < row_floats; ++j)
+                    to[j] = detail::float_to_byte(sum[j]);
+            }
+        });
+    }
+
+    void shift_hsv(Image& image, float hue_offset, float saturation_offset, float value_offset, ThreadPool* pool)
+    {
+        if (image.operator SDL_Surface*() == nullptr)
+            return;
+
+        // alpha is copied bitwise, so it does not drift through the float round trip
+        uint32_t alpha_mask;
+        const std::array<uint8_t, 4> mask_bytes = {0, 0, 0, 255};
+        std::memcpy(&alpha_mask, mask_bytes.data(), 4);
+
+        const size_t height = image.get_size().y;
+        detail::for_each_row_chunk(pool, height, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; ++y)
+            {
+                for (auto& pixel : image.get_row(y))
+                {
+                    auto hsva = HSVA(Image::bit_to_color(pixel));
+                    hsva.h = hsva.h + hue_offset - std::floor(hsva.h + hue_offset);
+                    hsva.s = std::clamp(hsva.s + saturation_offset, 0.f, 1.f);
+                    hsva.v = std::clamp(hsva.v + value_offset, 0.f, 1.f);
+
+                    pixel = (Image::color_to_bit(hsva.operator RGBA()) & ~alpha_mask) | (pixel & alpha_mask);
+                }
+            }
+        });
+    }
+
+    void premultiply_alpha(Image& image, ThreadPool* pool)
+    {
+        if (image.operator SDL_Surface*() == nullptr)
+            return;
+
+        const auto size = image.get_size();
+        detail::for_each_row_chunk(pool, size.y, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; ++y)
+                detail::premultiply_alpha(reinterpret_cast<uint8_t*>(image.get_row(y).data()), size.x);
+        });
+    }
+
+    void swizzle(Image& image, std::array<size_t, 4> order, ThreadPool* pool)
+    {
+        if (image.operator SDL_Surface*() == nullptr)
+            return;
+
+        for (auto i : order)
+        {
+            if (i > 3)
+            {
+                std::cerr << "[WARNING] In swizzle: Channel index " << i << " out of range, expected 0, 1, 2 or 3." << std::endl;
+                return;
+            }
+        }
+
+        const auto size = image.get_size();
+        detail::for_each_row_chunk(pool, size.y, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; ++y)
+            {
+                auto* bytes = reinterpret_cast<uint8_t*>(image.get_row(y).data());
+                size_t i = 0;
+
+                #if defined(MOUSETRAP_AVX2_DISPATCH)
+                if (detail::cpu_has_avx2())
+                    i = detail::swizzle_avx2(bytes, size.x, order);
+                #endif
+
+                detail::swizzle_scalar(bytes + i * 4, size.x - i, order);
+            }
+        });
+    }
+}
@@ -6,6 +6,8 @@
 #include <iostream>
 #include <SDL2/SDL.h>
 
+#include <include/profiler.hpp>
+
 namespace rat
 {
     template<typename... Ts>
@@ -32,6 +34,8 @@ namespace rat
 
     void InputHandler::update()
     {
+        PROFILE_SCOPE("input_handler.update");
+
         _keyboard_state[0] = _keyboard_state[1];
         _mouse_state[0] = _mouse_state[1];
         _mouse_state[1].scroll_delta = Vector2f(0, 0);
@@ -0,0 +1,268 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/29/22 by clem (mail@clemens-cords.com)
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <include/frame_stats.hpp>
+
+namespace rat
+{
+    OffscreenTarget::OffscreenTarget()
+    {}
+
+    OffscreenTarget::~OffscreenTarget()
+    {
+        close();
+    }
+
+    bool OffscreenTarget::create(size_t width, size_t height)
+    {
+        close();
+
+        if (SDL_WasInit(SDL_INIT_VIDEO) == 0)
+        {
+            // no display, e.g. on a render farm or in ci: fall back to sdl's offscreen driver, which uses egl
+            if (std::getenv("SDL_VIDEODRIVER") == nullptr and std::getenv("DISPLAY") == nullptr and std::getenv("WAYLAND_DISPLAY") == nullptr)
+                SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+
+            if (SDL_Init(SDL_INIT_VIDEO) != 0)
+            {
+                std::cerr << "[WARNING] In OffscreenTarget::create: Unable to initialize SDL video: " << SDL_GetError() << std::endl;
+                return false;
+            }
+        }
+
+        width = std::max<size_t>(width, 1);
+        height = std::max<size_t>(height, 1);
+
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+
+        // the default framebuffer is never drawn to, request the cheapest one
+        SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 0);
+        SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 0);
+        SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 0);
+
+        _window = SDL_CreateWindow("", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+        if (_window == nullptr)
+        {
+            std::cerr << "[WARNING] In OffscreenTarget::create: Unable to create hidden window: " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        _gl_context = SDL_GL_CreateContext(_window);
+        if (_gl_context == nullptr)
+        {
+            std::cerr << "[WARNING] In OffscreenTarget::create: Unable to create OpenGL context: " << SDL_GetError() << std::endl;
+            close();
+            return false;
+        }
+
+        glewExperimental = GL_TRUE;
+        if (glewInit() != GLEW_OK)
+            std::cerr << "[WARNING] In OffscreenTarget::create: Unable to initialize GLEW" << std::endl;
+
+        glGenFramebuffers(1, &_framebuffer_id);
+        glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer_id);
+
+        glGenRenderbuffers(1, &_color_buffer_id);
+        glBindRenderbuffer(GL_RENDERBUFFER, _color_buffer_id);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _color_buffer_id);
+
+        glGenRenderbuffers(1, &_depth_buffer_id);
+        glBindRenderbuffer(GL_RENDERBUFFER, _depth_buffer_id);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depth_buffer_id);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cerr << "[WARNING] In OffscreenTarget::create: Framebuffer incomplete, status " << status << std::endl;
+            close();
+            return false;
+        }
+
+        _size = Vector2ui(width, height);
+        _is_open = true;
+
+        glViewport(0, 0, width, height);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LEQUAL);
+
+        if (noop_shader == nullptr)
+            noop_shader = new Shader();
+
+        return true;
+    }
+
+    void OffscreenTarget::close()
+    {
+        if (_gl_context != nullptr)
+        {
+            SDL_GL_MakeCurrent(_window, _gl_context);
+            _download_ring.reset();
+
+            if (_framebuffer_id != 0)
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                glDeleteFramebuffers(1, &_framebuffer_id);
+            }
+
+            if (_color_buffer_id != 0)
+                glDeleteRenderbuffers(1, &_color_buffer_id);
+
+            if (_depth_buffer_id != 0)
+                glDeleteRenderbuffers(1, &_depth_buffer_id);
+        }
+
+        if (_gl_context != nullptr)
+            SDL_GL_DeleteContext(_gl_context);
+
+        if (_window != nullptr)
+            SDL_DestroyWindow(_window);
+
+        _framebuffer_id = 0;
+        _color_buffer_id = 0;
+        _depth_buffer_id = 0;
+        _gl_context = nullptr;
+        _window = nullptr;
+        _size = {0, 0};
+        _is_open = false;
+    }
+
+    bool OffscreenTarget::is_open() const
+    {
+        return _is_open;
+    }
+
+    Vector2ui OffscreenTarget::get_size() const
+    {
+        return _size;
+    }
+
+    void OffscreenTarget::bind() const
+    {
+        if (not _is_open)
+        {
+            std::cerr << "[WARNING] In OffscreenTarget::bind: Trying to bind a target that has not been created yet." << std::endl;
+            return;
+        }
+
+        if (SDL_GL_GetCurrentContext() != _gl_context)
+            SDL_GL_MakeCurrent(_window, _gl_context);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer_id);
+        glViewport(0, 0, _size.x, _size.y);
+    }
+
+    void OffscreenTarget::clear(RGBA color)
+    {
+        bind();
+
+        glClearColor(color.r, color.g, color.b, color.a);
+        glClearDepth(1);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    void OffscreenTarget::flush()
+    {
+        if (not _is_open)
+            return;
+
+        glFinish();
+        detail::frame_index += 1;
+    }
+
+    void OffscreenTarget::render(const Renderable* renderable, Shader& shader, Transform transform) const
+    {
+        bind();
+        renderable->render(this, shader, transform);
+    }
+
+    void OffscreenTarget::download(Image& image) const
+    {
+        if (not _is_open)
+        {
+            std::cerr << "[WARNING] In OffscreenTarget::download: Trying to download from a target that has not been created yet." << std::endl;
+            return;
+        }
+
+        bind();
+
+        if (image.get_size() != _size)
+            image.create(_size.x, _size.y);
+
+        SDL_Surface* surface = image;
+
+        // image is RGBA32, so rows can be read directly without per-pixel conversion
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glPixelStorei(GL_PACK_ROW_LENGTH, surface->pitch / 4);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glReadPixels(0, 0, _size.x, _size.y, GL_RGBA, GL_UNSIGNED_BYTE, surface->pixels);
+        glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+
+        // gl rows start at the bottom, sdl rows at the top
+        auto* pixels = static_cast<uint8_t*>(surface->pixels);
+        auto row = std::vector<uint8_t>(surface->pitch);
+
+        for (size_t y = 0; y < _size.y / 2; ++y)
+        {
+            auto* top = pixels + y * surface->pitch;
+            auto* bottom = pixels + (_size.y - 1 - y) * surface->pitch;
+
+            std::memcpy(row.data(), top, surface->pitch);
+            std::memcpy(top, bottom, surface->pitch);
+            std::memcpy(bottom, row.data(), surface->pitch);
+        }
+    }
+
+    AsyncDownload OffscreenTarget::download_async()
+    {
+        if (not _is_open)
+        {
+            std::cerr << "[WARNING] In OffscreenTarget::download_async: Trying to download from a target that has not been created yet." << std::endl;
+            return AsyncDownload();
+        }
+
+        bind();
+
+        if (_download_ring == nullptr)
+            _download_ring = std::make_shared<PixelBufferRing>();
+
+        return _download_ring->read(_framebuffer_id, GL_COLOR_ATTACHMENT0, _size);
+    }
+
+    GLNativeHandle OffscreenTarget::get_framebuffer_handle() const
+    {
+        return _framebuffer_id;
+    }
+
+    SDL_Renderer* OffscreenTarget::get_renderer()
+    {
+        return nullptr;
+    }
+
+    Transform OffscreenTarget::get_global_transform() const
+    {
+        return _global_transform;
+    }
+
+    void OffscreenTarget::set_global_transform(Transform transform)
+    {
+        _global_transform = transform;
+    }
+}
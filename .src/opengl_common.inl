@@ -4,6 +4,7 @@
 //
 
 #include <array>
+#include <algorithm>
 
 namespace rat
 {
@@ -43,7 +44,16 @@ namespace rat
 
     Vector3f sdl_to_gl_screen_position(Vector3f in)
     {
-        auto size = get_viewport_size();
+        return sdl_to_gl_screen_position(in, get_viewport_size());
+    }
+
+    Vector3f gl_to_sdl_screen_position(Vector3f in)
+    {
+        return gl_to_sdl_screen_position(in, get_viewport_size());
+    }
+
+    Vector3f sdl_to_gl_screen_position(Vector3f in, Vector2f size)
+    {
         auto centroid = Vector3f(size.x / 2, size.y / 2, 0);
 
         auto out = centroid - in;
@@ -53,9 +63,8 @@ namespace rat
         return out;
     }
 
-    Vector3f gl_to_sdl_screen_position(Vector3f in)
+    Vector3f gl_to_sdl_screen_position(Vector3f in, Vector2f size)
     {
-        auto size = get_viewport_size();
         auto centroid = Vector3f(size.x / 2, size.y / 2, 0);
 
         auto out = in;
@@ -68,13 +77,12 @@ namespace rat
 
     Vector2f sdl_to_gl_texture_coordinates(Vector2f in)
     {
-        in.x = 1 - in.x; // sdl texture are x-flipped
+        // all textures store their top row first, so no conversion is needed
         return in;
     }
 
     Vector2f gl_to_sdl_texture_coordinates(Vector2f in)
     {
-        in.x = 1 - in.x;
         return in;
     }
 
@@ -89,4 +97,10 @@ namespace rat
         auto size = get_viewport_size();
         return Vector2f(distance.x * (size.x * 0.5), -1 * distance.y * (size.y * 0.5));
     }
+
+    float layer_to_gl_depth(size_t layer)
+    {
+        layer = std::min(layer, max_layer);
+        return 1.f - 2.f * (float(layer) / float(max_layer + 1));
+    }
 }
\ No newline at end of file
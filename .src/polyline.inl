@@ -0,0 +1,222 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/27/22 by clem (mail@clemens-cords.com)
+//
+
+#include <iostream>
+#include <algorithm>
+
+#include <include/opengl_common.hpp>
+#include <include/command_buffer.hpp>
+#include <include/frame_stats.hpp>
+
+namespace rat
+{
+    Polyline::Polyline()
+    {
+        glGenVertexArrays(1, &_vertex_array_id);
+        glGenBuffers(1, &_instance_buffer_id);
+    }
+
+    Polyline::~Polyline()
+    {
+        glDeleteVertexArrays(1, &_vertex_array_id);
+        glDeleteBuffers(1, &_instance_buffer_id);
+    }
+
+    void Polyline::initialize_shader()
+    {
+        if (_shader != nullptr)
+            return;
+
+        // vertex shader first, its outputs are a superset of the noop fragment shaders inputs
+        _shader = new Shader();
+        _shader->create_from_string(_vertex_shader_source, ShaderType::VERTEX);
+        _shader->create_from_string(_fragment_shader_source, ShaderType::FRAGMENT);
+    }
+
+    void Polyline::create(const std::vector<Vector2f>& points, bool closed)
+    {
+        clear();
+        add_strip(points, RGBA(1, 1, 1, 1), closed);
+    }
+
+    void Polyline::add_strip(const std::vector<Vector2f>& points, RGBA color, bool closed)
+    {
+        if (points.size() < 2)
+        {
+            std::cerr << "[WARNING] In Polyline::add_strip: A strip needs at least 2 points, got " << points.size() << "." << std::endl;
+            return;
+        }
+
+        closed = closed and points.size() > 2;
+        const size_t n_segments = closed ? points.size() : points.size() - 1;
+
+        _segments.reserve(_segments.size() + n_segments);
+        for (size_t i = 0; i < n_segments; ++i)
+        {
+            _segments.push_back(Segment{
+                points.at(i),
+                points.at((i + 1) % points.size()),
+                color,
+                not closed and i == 0,
+                not closed and i == n_segments - 1
+            });
+        }
+
+        _instance_data_dirty = true;
+    }
+
+    void Polyline::add_segment(Vector2f a, Vector2f b, RGBA color)
+    {
+        _segments.push_back(Segment{a, b, color, true, true});
+        _instance_data_dirty = true;
+    }
+
+    void Polyline::clear()
+    {
+        _segments.clear();
+        _instance_data_dirty = true;
+    }
+
+    size_t Polyline::get_n_segments() const
+    {
+        return _segments.size();
+    }
+
+    void Polyline::set_width(float width)
+    {
+        _width = std::max<float>(width, 0);
+    }
+
+    float Polyline::get_width() const
+    {
+        return _width;
+    }
+
+    void Polyline::set_cap_type(CapType type)
+    {
+        _cap_type = type;
+        _instance_data_dirty = true;
+    }
+
+    CapType Polyline::get_cap_type() const
+    {
+        return _cap_type;
+    }
+
+    void Polyline::set_join_type(JoinType type)
+    {
+        _join_type = type;
+        _instance_data_dirty = true;
+    }
+
+    JoinType Polyline::get_join_type() const
+    {
+        return _join_type;
+    }
+
+    void Polyline::set_color(RGBA color)
+    {
+        for (auto& segment : _segments)
+            segment.color = color;
+
+        _instance_data_dirty = true;
+    }
+
+    void Polyline::set_layer(size_t layer)
+    {
+        _layer = std::min(layer, max_layer);
+    }
+
+    size_t Polyline::get_layer() const
+    {
+        return _layer;
+    }
+
+    void Polyline::update_instance_data() const
+    {
+        const float cap = static_cast<float>(_cap_type),
+                    join = static_cast<float>(_join_type);
+
+        _instance_data.clear();
+        _instance_data.reserve(_segments.size() * _n_floats_per_instance);
+
+        for (auto& segment : _segments)
+        {
+            for (float f : {segment.a.x, segment.a.y, segment.b.x, segment.b.y})
+                _instance_data.push_back(f);
+
+            for (float f : {segment.color.r, segment.color.g, segment.color.b, segment.color.a})
+                _instance_data.push_back(f);
+
+            _instance_data.push_back(segment.a_is_end ? cap : join);
+            _instance_data.push_back(segment.b_is_end ? cap : join);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, _instance_buffer_id);
+
+        // only reallocate storage if the data outgrew it
+        const size_t size = _instance_data.size() * sizeof(float);
+        if (size > _instance_buffer_capacity)
+        {
+            glBufferData(GL_ARRAY_BUFFER, size, _instance_data.data(), GL_DYNAMIC_DRAW);
+            _instance_buffer_capacity = size;
+        }
+        else
+            glBufferSubData(GL_ARRAY_BUFFER, 0, size, _instance_data.data());
+
+        detail::count_buffer_upload(size);
+
+        glBindVertexArray(_vertex_array_id);
+
+        const GLsizei stride = _n_floats_per_instance * sizeof(float);
+
+        // end points: vec4 at layout = 0
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (void*) 0);
+        glVertexAttribDivisor(0, 1);
+        glEnableVertexAttribArray(0);
+
+        // color: vec4 at layout = 1
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*) (4 * sizeof(float)));
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(1);
+
+        // cap types: vec2 at layout = 2
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*) (8 * sizeof(float)));
+        glVertexAttribDivisor(2, 1);
+        glEnableVertexAttribArray(2);
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        _instance_data_dirty = false;
+    }
+
+    void Polyline::render(const RenderTarget* target, Shader&, Transform transform) const
+    {
+        if (_segments.empty())
+            return;
+
+        initialize_shader();
+
+        if (_instance_data_dirty)
+            update_instance_data();
+
+        transform = target->combine_transforms(transform, target->get_global_transform());
+        const auto viewport = get_viewport_size();
+        const auto program_id = _shader->get_program_id();
+
+        glUseProgram(program_id);
+        detail::count_program_use(program_id);
+        glUniformMatrix4fv(glGetUniformLocation(program_id, "_transform"), 1, GL_FALSE, &transform.transform[0][0]);
+        glUniform2f(glGetUniformLocation(program_id, "_viewport_size"), viewport.x, viewport.y);
+        glUniform1f(glGetUniformLocation(program_id, "_half_width"), _width / 2);
+        glUniform1f(glGetUniformLocation(program_id, "_depth"), layer_to_gl_depth(_layer));
+
+        glBindVertexArray(_vertex_array_id);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, _segments.size());
+        detail::count_draw_call(4 * _segments.size());
+        glBindVertexArray(0);
+    }
+}
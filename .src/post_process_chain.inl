@@ -0,0 +1,229 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/30/22 by clem (mail@clemens-cords.com)
+//
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <include/frame_stats.hpp>
+
+namespace rat
+{
+    PostProcessChain::PostProcessChain(Window& window, size_t n_samples)
+        : _window(&window), _scene(window), _ping(window), _pong(window), _n_samples(n_samples)
+    {}
+
+    void PostProcessChain::initialize()
+    {
+        if (_vertex_array_id != 0)
+            return;
+
+        glGenVertexArrays(1, &_vertex_array_id);
+
+        // fragment stage first, it links with the noop vertex stage until that is replaced
+        _copy_shader = new Shader();
+        _copy_shader->create_from_string(_copy_fragment_shader_source, ShaderType::FRAGMENT);
+        _copy_shader->create_from_string(_vertex_shader_source, ShaderType::VERTEX);
+    }
+
+    size_t PostProcessChain::add_pass(const std::string& fragment_shader_source)
+    {
+        auto pass = Pass();
+        pass.shader = std::make_unique<Shader>();
+        pass.shader->create_from_string(fragment_shader_source, ShaderType::FRAGMENT);
+        pass.shader->create_from_string(_vertex_shader_source, ShaderType::VERTEX);
+
+        _passes.push_back(std::move(pass));
+        return _passes.size() - 1;
+    }
+
+    size_t PostProcessChain::add_pass_from_file(const std::string& path)
+    {
+        auto file = std::ifstream(path);
+        if (not file.is_open())
+            std::cerr << "[WARNING] In PostProcessChain::add_pass_from_file: Unable to open file at `" << path << "`" << std::endl;
+
+        auto str = std::stringstream();
+        str << file.rdbuf();
+        return add_pass(str.str());
+    }
+
+    Shader& PostProcessChain::get_pass_shader(size_t index)
+    {
+        return *_passes.at(index).shader;
+    }
+
+    void PostProcessChain::set_pass_enabled(size_t index, bool b)
+    {
+        _passes.at(index).enabled = b;
+    }
+
+    bool PostProcessChain::get_pass_enabled(size_t index) const
+    {
+        return _passes.at(index).enabled;
+    }
+
+    size_t PostProcessChain::get_n_passes() const
+    {
+        return _passes.size();
+    }
+
+    void PostProcessChain::clear_passes()
+    {
+        _passes.clear();
+    }
+
+    RenderTexture& PostProcessChain::get_scene_texture()
+    {
+        return _scene;
+    }
+
+    void PostProcessChain::begin(RGBA color)
+    {
+        if (_active)
+        {
+            std::cerr << "[WARNING] In PostProcessChain::begin: Chain is already active, call `end` first." << std::endl;
+            return;
+        }
+
+        initialize();
+
+        // the only place textures are allocated
+        auto size = _window->get_size();
+        if (size != _size)
+        {
+            _scene.create(size.x, size.y, true, _n_samples); // depth, so layers still work
+            _ping.create(size.x, size.y);
+            _pong.create(size.x, size.y);
+            _size = size;
+        }
+
+        // the default framebuffer and OffscreenTarget store the bottom row first, render textures the top row
+        GLint output_framebuffer;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &output_framebuffer);
+        _flip_output = not RenderTexture::is_render_texture_framebuffer(output_framebuffer);
+
+        _scene.bind_as_render_target();
+        _scene.clear(color);
+        _active = true;
+    }
+
+    void PostProcessChain::end()
+    {
+        if (not _active)
+        {
+            std::cerr << "[WARNING] In PostProcessChain::end: Chain is not active, call `begin` first." << std::endl;
+            return;
+        }
+
+        // resolves msaa and restores the framebuffer bound before begin
+        _scene.unbind_as_render_target();
+        _active = false;
+
+        GLint output_framebuffer;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &output_framebuffer);
+
+        const bool blend_enabled = glIsEnabled(GL_BLEND),
+                   depth_test_enabled = glIsEnabled(GL_DEPTH_TEST);
+
+        // passes replace the previous content
+        glDisable(GL_BLEND);
+        glDisable(GL_DEPTH_TEST);
+
+        size_t n_remaining = 0;
+        for (auto& pass : _passes)
+            n_remaining += pass.enabled;
+
+        if (n_remaining == 0)
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, output_framebuffer);
+            draw_pass(*_copy_shader, _scene, _flip_output);
+        }
+
+        const RenderTexture* input = &_scene;
+        for (auto& pass : _passes)
+        {
+            if (not pass.enabled)
+                continue;
+
+            n_remaining -= 1;
+
+            if (n_remaining == 0)
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, output_framebuffer);
+                draw_pass(*pass.shader, *input, _flip_output);
+                break;
+            }
+
+            // never write into the texture that is being read
+            RenderTexture& output = input == &_ping ? _pong : _ping;
+            output.bind_as_render_target();
+            draw_pass(*pass.shader, *input, false);
+            output.unbind_as_render_target();
+
+            input = &output;
+        }
+
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        if (blend_enabled)
+            glEnable(GL_BLEND);
+
+        if (depth_test_enabled)
+            glEnable(GL_DEPTH_TEST);
+    }
+
+    void PostProcessChain::draw_pass(const Shader& shader, const RenderTexture& input, bool flip)
+    {
+        auto program_id = shader.get_program_id();
+        glUseProgram(program_id);
+        detail::count_program_use(program_id);
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, _scene.get_native_handle());
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, input.get_native_handle());
+        detail::count_texture_bind();
+
+        glUniform1i(glGetUniformLocation(program_id, "_texture"), 0);
+        glUniform1i(glGetUniformLocation(program_id, "_scene"), 1);
+        glUniform2f(glGetUniformLocation(program_id, "_texture_size"), _size.x, _size.y);
+        glUniform1i(glGetUniformLocation(program_id, "_flip"), flip ? 1 : 0);
+
+        glBindVertexArray(_vertex_array_id);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        detail::count_draw_call(3);
+    }
+
+    void PostProcessChain::render(const Renderable* renderable, Shader& shader, Transform transform) const
+    {
+        if (not _active)
+            std::cerr << "[WARNING] In PostProcessChain::render: Chain is not active, call `begin` before rendering." << std::endl;
+
+        _scene.render(renderable, shader, transform);
+    }
+
+    SDL_Renderer* PostProcessChain::get_renderer()
+    {
+        return _window->get_renderer();
+    }
+
+    Transform PostProcessChain::get_global_transform() const
+    {
+        return _scene.get_global_transform();
+    }
+
+    void PostProcessChain::set_global_transform(Transform transform)
+    {
+        _scene.set_global_transform(transform);
+    }
+
+    Transform PostProcessChain::combine_transforms(Transform transform, Transform global_transform) const
+    {
+        return _scene.combine_transforms(transform, global_transform);
+    }
+}
@@ -0,0 +1,177 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/28/22 by clem (mail@clemens-cords.com)
+//
+
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+namespace rat
+{
+    int64_t Profiler::now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch).count();
+    }
+
+    void Profiler::ThreadBuffer::push(Event event)
+    {
+        auto n = n_written.load(std::memory_order_relaxed);
+        events[n % events_per_thread] = event;
+        n_written.store(n + 1, std::memory_order_release);
+    }
+
+    Profiler::ThreadBuffer& Profiler::get_thread_buffer()
+    {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (buffer != nullptr)
+            return *buffer;
+
+        auto lock = std::lock_guard(_registry_mutex);
+        _thread_buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = _thread_buffers.back().get();
+        buffer->thread_index = _thread_buffers.size();
+        return *buffer;
+    }
+
+    Profiler::ThreadBuffer& Profiler::get_gpu_buffer()
+    {
+        static auto* buffer = new ThreadBuffer();
+        return *buffer;
+    }
+
+    bool Profiler::begin_gpu_query(const char* name)
+    {
+        if (_gpu_query_active)
+            return false;
+
+        if (_free_queries.empty())
+        {
+            if (_pending_queries.size() >= n_gpu_queries)
+                return false;
+
+            GLNativeHandle query;
+            glGenQueries(1, &query);
+            _free_queries.push_back(query);
+        }
+
+        auto pending = PendingQuery();
+        pending.query = _free_queries.back();
+        pending.event.name = name;
+        pending.event.begin_ns = now();
+        _free_queries.pop_back();
+
+        glBeginQuery(GL_TIME_ELAPSED, pending.query);
+        _pending_queries.push_back(pending);
+        _gpu_query_active = true;
+        return true;
+    }
+
+    void Profiler::end_gpu_query()
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        _gpu_query_active = false;
+    }
+
+    void Profiler::end_frame()
+    {
+        // results arrive in order, stop at the first one that is not ready instead of stalling
+        size_t n_resolved = 0;
+        for (auto& pending : _pending_queries)
+        {
+            if (_gpu_query_active and &pending == &_pending_queries.back())
+                break;
+
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(pending.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available != GL_TRUE)
+                break;
+
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(pending.query, GL_QUERY_RESULT, &elapsed);
+
+            pending.event.duration_ns = elapsed;
+            get_gpu_buffer().push(pending.event);
+            _free_queries.push_back(pending.query);
+            n_resolved += 1;
+        }
+
+        _pending_queries.erase(_pending_queries.begin(), _pending_queries.begin() + n_resolved);
+    }
+
+    bool Profiler::export_chrome_trace(const std::string& path)
+    {
+        auto file = std::ofstream(path);
+        if (not file.is_open())
+        {
+            std::cerr << "[WARNING] In Profiler::export_chrome_trace: Unable to open file at `" << path << "`" << std::endl;
+            return false;
+        }
+
+        bool first = true;
+        auto write_events = [&](const ThreadBuffer& buffer, size_t pid, size_t tid)
+        {
+            const size_t n_written = buffer.n_written.load(std::memory_order_acquire);
+            const size_t n = std::min(n_written, events_per_thread);
+
+            for (size_t i = n_written - n; i < n_written; ++i)
+            {
+                auto& event = buffer.events[i % events_per_thread];
+                if (event.name == nullptr)
+                    continue;
+
+                file << (first ? "\n" : ",\n");
+                first = false;
+
+                // chrome trace timestamps are in microseconds
+                file << "{\"name\":\"" << event.name << "\",\"ph\":\"X\""
+                     << ",\"ts\":" << event.begin_ns / 1000.0
+                     << ",\"dur\":" << event.duration_ns / 1000.0
+                     << ",\"pid\":" << pid << ",\"tid\":" << tid << "}";
+            }
+        };
+
+        file << "{\"traceEvents\":[";
+
+        {
+            auto lock = std::lock_guard(_registry_mutex);
+            for (auto& buffer : _thread_buffers)
+                write_events(*buffer, 0, buffer->thread_index);
+        }
+
+        // gpu timings are placed at the cpu time the query was issued
+        write_events(get_gpu_buffer(), 1, 0);
+
+        file << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+        return true;
+    }
+
+    void Profiler::clear()
+    {
+        auto lock = std::lock_guard(_registry_mutex);
+        for (auto& buffer : _thread_buffers)
+            buffer->n_written.store(0, std::memory_order_release);
+
+        get_gpu_buffer().n_written.store(0, std::memory_order_release);
+    }
+
+    ProfileScope::ProfileScope(const char* name)
+        : _name(name), _begin_ns(Profiler::now())
+    {}
+
+    ProfileScope::~ProfileScope()
+    {
+        const auto end_ns = Profiler::now();
+        Profiler::get_thread_buffer().push(Profiler::Event{_name, _begin_ns, end_ns - _begin_ns});
+    }
+
+    GpuProfileScope::GpuProfileScope(const char* name)
+        : _active(Profiler::begin_gpu_query(name))
+    {}
+
+    GpuProfileScope::~GpuProfileScope()
+    {
+        if (_active)
+            Profiler::end_gpu_query();
+    }
+}
@@ -0,0 +1,158 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/25/22 by clem (mail@clemens-cords.com)
+//
+
+#include <array>
+#include <algorithm>
+#include <iostream>
+
+#include <include/profiler.hpp>
+
+namespace rat
+{
+    RenderQueue::RenderQueue(RenderTarget* target)
+        : _target(target)
+    {}
+
+    RenderSortKey RenderQueue::make_opaque_sort_key(GLNativeHandle shader, GLNativeHandle texture, size_t layer)
+    {
+        auto inverted_layer = RenderSortKey(max_layer - std::min(layer, max_layer));
+
+        return ((RenderSortKey(shader) & _16_bit_mask) << 48) |
+               ((RenderSortKey(texture) & _16_bit_mask) << 32) |
+               ((inverted_layer & _16_bit_mask) << 16);
+    }
+
+    RenderSortKey RenderQueue::make_transparent_sort_key(size_t layer, float depth, GLNativeHandle shader, GLNativeHandle texture)
+    {
+        depth = std::clamp<float>(depth, 0, 1);
+        auto quantized_depth = RenderSortKey(depth * _16_bit_mask);
+
+        return ((RenderSortKey(std::min(layer, max_layer)) & _16_bit_mask) << 48) |
+               ((quantized_depth & _16_bit_mask) << 32) |
+               ((RenderSortKey(shader) & _16_bit_mask) << 16) |
+               (RenderSortKey(texture) & _16_bit_mask);
+    }
+
+    void RenderQueue::submit(const Renderable* renderable, Shader& shader, Transform transform, float depth)
+    {
+        if (renderable == nullptr)
+            return;
+
+        const auto program = shader.get_program_id();
+        const auto texture = renderable->get_native_texture_handle();
+        const auto layer = renderable->get_layer();
+
+        if (renderable->is_opaque())
+            _opaque_keys.emplace_back(make_opaque_sort_key(program, texture, layer), _submissions.size());
+        else
+            _transparent_keys.emplace_back(make_transparent_sort_key(layer, depth, program, texture), _submissions.size());
+
+        _submissions.push_back(Submission{renderable, &shader, transform});
+    }
+
+    void RenderQueue::sort(std::vector<KeyIndexPair>& keys)
+    {
+        // lsd radix sort, 8 bit per pass. Stable, so submissions with equal keys keep their call order
+        const size_t n = keys.size();
+        if (n == 0)
+            return;
+
+        _keys_swap.resize(n);
+
+        for (size_t pass = 0; pass < sizeof(RenderSortKey); ++pass)
+        {
+            const size_t shift = pass * 8;
+
+            auto histogram = std::array<size_t, 256>();
+            histogram.fill(0);
+
+            for (auto& pair : keys)
+                histogram[(pair.first >> shift) & 0xFF] += 1;
+
+            // all keys share this byte, pass would not change the order
+            if (histogram[(keys.front().first >> shift) & 0xFF] == n)
+                continue;
+
+            size_t offset = 0;
+            for (auto& count : histogram)
+            {
+                auto temp = count;
+                count = offset;
+                offset += temp;
+            }
+
+            for (auto& pair : keys)
+                _keys_swap[histogram[(pair.first >> shift) & 0xFF]++] = pair;
+
+            std::swap(keys, _keys_swap);
+        }
+    }
+
+    void RenderQueue::flush()
+    {
+        if (_submissions.empty())
+            return;
+
+        if (_target == nullptr)
+        {
+            std::cerr << "[WARNING] In RenderQueue::flush: render target is null, " << _submissions.size() << " submissions will be discarded." << std::endl;
+            clear();
+            return;
+        }
+
+        PROFILE_SCOPE("render_queue.flush");
+        PROFILE_GPU_SCOPE("render_queue.flush");
+
+        sort(_opaque_keys);
+        sort(_transparent_keys);
+
+        auto buffer = CommandBuffer(_target);
+
+        glDepthMask(GL_TRUE);
+        render_pass(_opaque_keys, buffer);
+
+        // transparent objects are still depth tested against opaque ones, but may not occlude each other
+        glDepthMask(GL_FALSE);
+        render_pass(_transparent_keys, buffer);
+        glDepthMask(GL_TRUE);
+
+        clear();
+    }
+
+    void RenderQueue::render_pass(const std::vector<KeyIndexPair>& keys, CommandBuffer& buffer)
+    {
+        // record in sorted order, so neighbouring submissions with the same shader and texture share a draw call
+        buffer.clear();
+        for (auto& pair : keys)
+        {
+            auto& submission = _submissions[pair.second];
+            buffer.record(submission.renderable, *submission.shader, submission.transform);
+        }
+
+        buffer.submit();
+    }
+
+    void RenderQueue::clear()
+    {
+        _submissions.clear();
+        _opaque_keys.clear();
+        _transparent_keys.clear();
+    }
+
+    size_t RenderQueue::get_n_submissions() const
+    {
+        return _submissions.size();
+    }
+
+    RenderTarget* RenderQueue::get_render_target() const
+    {
+        return _target;
+    }
+
+    void RenderQueue::set_render_target(RenderTarget* target)
+    {
+        _target = target;
+    }
+}
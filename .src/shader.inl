@@ -39,6 +39,10 @@ namespace rat
         else
             _vertex_shader_id = compile_shader(code, type);
 
+        // replacing one stage relinks, previous program is no longer needed
+        if (_program_id != 0 and _program_id != _noop_program_id)
+            glDeleteProgram(_program_id);
+
         _program_id = link_program(_fragment_shader_id, _vertex_shader_id);
     }
 
@@ -5,6 +5,8 @@
 
 #include <stdexcept>
 #include <algorithm>
+#include <iostream>
+#include <cmath>
 
 #include <glm/glm.hpp>
 #include <SDL2/SDL_render.h>
@@ -15,6 +17,10 @@
 #include <include/shape.hpp>
 #include <include/texture.hpp>
 #include <include/transform.hpp>
+#include <include/opengl_common.hpp>
+#include <include/command_buffer.hpp>
+#include <include/profiler.hpp>
+#include <include/frame_stats.hpp>
 
 namespace rat
 {
@@ -29,8 +35,9 @@ namespace rat
         _vertices = other._vertices;
         _texture = other._texture;
         _texture_rect = other._texture_rect;
-        _render_type = other._render_type;
         _origin = other._origin;
+        _layer = other._layer;
+        _buffer_usage = other._buffer_usage;
         _indices = other._indices;
 
         initialize();
@@ -47,11 +54,17 @@ namespace rat
         glGenBuffers(1, &_texture_coordinate_buffer_id);
         glGenBuffers(1, &_element_buffer_id);
 
+        _element_buffer_n_bytes = 0;
+        _position_buffer_n_bytes = 0;
+        _color_buffer_n_bytes = 0;
+        _texture_coordinate_buffer_n_bytes = 0;
+
         _vertices = other._vertices;
         _texture = other._texture;
         _texture_rect = other._texture_rect;
-        _render_type = other._render_type;
         _origin = other._origin;
+        _layer = other._layer;
+        _buffer_usage = other._buffer_usage;
         _indices = other._indices;
 
         initialize();
@@ -69,8 +82,9 @@ namespace rat
         _vertices = std::move(other._vertices);
         _texture = std::move(other._texture);
         _texture_rect = std::move(other._texture_rect);
-        _render_type = std::move(other._render_type);
         _origin = std::move(other._origin);
+        _layer = other._layer;
+        _buffer_usage = other._buffer_usage;
         _indices = std::move(other._indices);
 
         initialize();
@@ -87,11 +101,17 @@ namespace rat
         glGenBuffers(1, &_texture_coordinate_buffer_id);
         glGenBuffers(1, &_element_buffer_id);
 
+        _element_buffer_n_bytes = 0;
+        _position_buffer_n_bytes = 0;
+        _color_buffer_n_bytes = 0;
+        _texture_coordinate_buffer_n_bytes = 0;
+
         _vertices = std::move(other._vertices);
         _texture = std::move(other._texture);
         _texture_rect = std::move(other._texture_rect);
-        _render_type = std::move(other._render_type);
         _origin = std::move(other._origin);
+        _layer = other._layer;
+        _buffer_usage = other._buffer_usage;
         _indices = std::move(other._indices);
 
         initialize();
@@ -124,36 +144,46 @@ namespace rat
 
     void Shape::render(const RenderTarget* target, Shader& shader, Transform transform) const
     {
-        GLNativeHandle program_id = shader.get_program_id();
-        transform = transform.combine_with(target->get_global_transform());
+        PROFILE_SCOPE("shape.render");
 
-        auto positions = _positions;
-        for (size_t i = 2; i < positions.size(); i += 3)
-        {
-            auto gl_point = Vector3f(positions.at(i-2), positions.at(i-1), positions.at(0));
-            auto sdl_point = gl_to_sdl_screen_position(gl_point);
-            sdl_point = transform.apply_to(sdl_point);
-            gl_point = sdl_to_gl_screen_position(sdl_point);
+        GLNativeHandle program_id = shader.get_program_id();
+        transform = target->combine_transforms(transform, target->get_global_transform());
 
-            positions.at(i-2) = gl_point.x;
-            positions.at(i-1) = gl_point.y;
-            positions.at(i) = gl_point.z;
-        }
+        auto positions = std::vector<float>();
+        transform_positions(transform, get_viewport_size(), positions);
 
         glUseProgram(program_id);
+        detail::count_program_use(program_id);
         glBindVertexArray(_vertex_array_id);
 
         if (_texture != nullptr)
             _texture->bind();
 
         glEnableVertexAttribArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, _position_buffer_id);
-        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), positions.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(shader.get_vertex_position_location(), 3, GL_FLOAT, GL_FALSE, 0, (void*) 0);
+
+        const size_t n_bytes = positions.size() * sizeof(float);
+        if (_buffer_usage == BufferUsage::STREAM)
+        {
+            if (_streaming_position_buffer == nullptr)
+                _streaming_position_buffer = std::make_unique<StreamingBuffer>(GL_ARRAY_BUFFER);
+
+            auto offset = _streaming_position_buffer->write(positions.data(), n_bytes);
+            glVertexAttribPointer(shader.get_vertex_position_location(), 3, GL_FLOAT, GL_FALSE, 0, (void*) offset);
+        }
+        else
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, _position_buffer_id);
+            upload(GL_ARRAY_BUFFER, positions.data(), n_bytes, _position_buffer_n_bytes);
+            glVertexAttribPointer(shader.get_vertex_position_location(), 3, GL_FLOAT, GL_FALSE, 0, (void*) 0);
+        }
 
         glUniform1i(glGetUniformLocation(program_id, "_texture_set"), _texture != nullptr);
 
-        glDrawElements(_render_type, _indices.size(), GL_UNSIGNED_INT, _indices.data());
+        glDrawElements(GL_TRIANGLES, _indices.size(), GL_UNSIGNED_INT, (void*) 0);
+        detail::count_draw_call(_indices.size());
+
+        if (_buffer_usage == BufferUsage::STREAM)
+            _streaming_position_buffer->fence();
 
         glBindVertexArray(0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -162,6 +192,50 @@ namespace rat
             _texture->unbind();
     }
 
+    void Shape::record(CommandBuffer& buffer, Shader& shader, Transform transform) const
+    {
+        if (_vertices.empty())
+            return;
+
+        transform = buffer.combine_transforms(transform);
+
+        const size_t offset = buffer._positions.size();
+        transform_positions(transform, buffer.get_viewport(), buffer._positions);
+
+        if (buffer.is_culled(offset))
+        {
+            buffer._positions.resize(offset);
+            buffer._n_culled += 1;
+            return;
+        }
+
+        buffer._colors.insert(buffer._colors.end(), _colors.begin(), _colors.end());
+        buffer._texture_coordinates.insert(buffer._texture_coordinates.end(), _texture_coordinates.begin(), _texture_coordinates.end());
+
+        auto command = CommandBuffer::Command();
+        command.texture = _texture;
+        command.indices = &_indices;
+        command.vertex_offset = offset / 3;
+        command.shader = &shader;
+
+        buffer._commands.push_back(command);
+    }
+
+    void Shape::transform_positions(Transform transform, Vector2f viewport_size, std::vector<float>& out) const
+    {
+        out.reserve(out.size() + _vertices.size() * 3);
+
+        for (auto& v : _vertices)
+        {
+            auto sdl_point = transform.apply_to(v.position);
+            auto gl_point = sdl_to_gl_screen_position(sdl_point, viewport_size);
+
+            out.push_back(gl_point.x);
+            out.push_back(gl_point.y);
+            out.push_back(v.position.z);
+        }
+    }
+
     void Shape::update_positions()
     {
         _positions.clear();
@@ -181,7 +255,7 @@ namespace rat
 
         // vertex position: vec3 at layout = 0
         glBindBuffer(GL_ARRAY_BUFFER, _position_buffer_id);
-        glBufferData(GL_ARRAY_BUFFER, _positions.size() * sizeof(float), _positions.data(), GL_STATIC_DRAW);
+        upload(GL_ARRAY_BUFFER, _positions.data(), _positions.size() * sizeof(float), _position_buffer_n_bytes);
         glVertexAttribPointer(Shader::get_vertex_position_location(), 3, GL_FLOAT, GL_FALSE, 0, (void*) 0);
         glEnableVertexAttribArray(0);
 
@@ -193,10 +267,12 @@ namespace rat
     {
         _colors.clear();
         _positions.reserve(_vertices.size() * 4);
+        _all_vertices_opaque = true;
 
         for (size_t i = 0; i < _vertices.size(); ++i)
         {
             const auto& col = _vertices.at(i).color;
+            _all_vertices_opaque = _all_vertices_opaque and col.a >= 1;
 
             _colors.push_back(col.r);
             _colors.push_back(col.g);
@@ -208,7 +284,7 @@ namespace rat
 
         // color: rgba at layout = 1
         glBindBuffer(GL_ARRAY_BUFFER, _color_buffer_id);
-        glBufferData(GL_ARRAY_BUFFER, _colors.size() * sizeof(float), _colors.data(), GL_STATIC_DRAW);
+        upload(GL_ARRAY_BUFFER, _colors.data(), _colors.size() * sizeof(float), _color_buffer_n_bytes);
         glVertexAttribPointer(Shader::get_vertex_color_location(), 4, GL_FLOAT, GL_FALSE, 0, (void*) 0);
         glEnableVertexAttribArray(1);
 
@@ -232,7 +308,7 @@ namespace rat
 
         // tex coord: vec2 at layout = 2
         glBindBuffer(GL_ARRAY_BUFFER, _texture_coordinate_buffer_id);
-        glBufferData(GL_ARRAY_BUFFER, _texture_coordinates.size() * sizeof(float), _texture_coordinates.data(), GL_STATIC_DRAW);
+        upload(GL_ARRAY_BUFFER, _texture_coordinates.data(), _texture_coordinates.size() * sizeof(float), _texture_coordinate_buffer_n_bytes);
         glVertexAttribPointer(Shader::get_vertex_texture_coordinate_location(), 2, GL_FLOAT, GL_FALSE, 0, (void*) 0);
         glEnableVertexAttribArray(2);
 
@@ -244,58 +320,147 @@ namespace rat
     {
         glBindVertexArray(_vertex_array_id);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _element_buffer_id);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(float), _indices.data(), GL_STATIC_DRAW);
+        upload(GL_ELEMENT_ARRAY_BUFFER, _indices.data(), _indices.size() * sizeof(uint32_t), _element_buffer_n_bytes);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        // the element buffer binding is part of the vertex array state, so the vertex array is unbound first to keep it
         glBindVertexArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
-    Vector2f Shape::get_centroid() const
+    void Shape::upload(GLenum target, const void* data, size_t n_bytes, size_t& n_allocated) const
     {
-        Vector3f sum = Vector3f(0);
-        for (auto& v : _vertices)
-            sum += v.position;
+        // same size: overwrite in-place instead of reallocating storage
+        if (n_bytes > 0 and n_allocated == n_bytes)
+            glBufferSubData(target, 0, n_bytes, data);
+        else
+        {
+            glBufferData(target, n_bytes, data, static_cast<GLenum>(_buffer_usage));
+            n_allocated = n_bytes;
+        }
 
-        return sum / Vector3f(_vertices.size());
+        detail::count_buffer_upload(n_bytes);
     }
 
-    void Shape::set_centroid(Vector2f position)
+    void Shape::set_buffer_usage(BufferUsage usage)
     {
-        auto delta = position - get_centroid();
-        for (auto& v : _vertices)
+        if (usage == _buffer_usage)
+            return;
+
+        _buffer_usage = usage;
+
+        if (_buffer_usage != BufferUsage::STREAM)
+            _streaming_position_buffer.reset();
+
+        // reallocate storage with the new hint
+        for (auto id : {_position_buffer_id, _color_buffer_id, _texture_coordinate_buffer_id})
         {
-            v.position.x += delta.x;
-            v.position.y += delta.y;
+            glBindBuffer(GL_ARRAY_BUFFER, id);
+            glBufferData(GL_ARRAY_BUFFER, 0, nullptr, static_cast<GLenum>(_buffer_usage));
         }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        _position_buffer_n_bytes = 0;
+        _color_buffer_n_bytes = 0;
+        _texture_coordinate_buffer_n_bytes = 0;
 
         update_positions();
+        update_colors();
+        update_texture_coordinates();
     }
 
-    Rectangle Shape::get_bounding_box() const
+    BufferUsage Shape::get_buffer_usage() const
+    {
+        return _buffer_usage;
+    }
+
+    void Shape::update_bounds()
     {
-        float min_x = infinity<float>;
-        float min_y = infinity<float>;
-        float min_z = infinity<float>;
+        if (_vertices.empty())
+        {
+            _bounding_box = Rectangle{{0, 0}, {0, 0}};
+            _centroid = Vector2f(0, 0);
+            return;
+        }
 
-        float max_x = negative_infinity<float>;
-        float max_y = negative_infinity<float>;
-        float max_z = negative_infinity<float>;
+        float min_x = infinity<float>,
+              min_y = infinity<float>;
+
+        float max_x = negative_infinity<float>,
+              max_y = negative_infinity<float>;
+
+        Vector2f sum = Vector2f(0, 0);
 
         for (auto& v : _vertices)
         {
             min_x = std::min(min_x, v.position.x);
             min_y = std::min(min_y, v.position.y);
-            min_z = std::min(min_z, v.position.z);
 
             max_x = std::max(max_x, v.position.x);
             max_y = std::max(max_y, v.position.y);
-            max_z = std::max(max_z, v.position.z);
+
+            sum.x += v.position.x;
+            sum.y += v.position.y;
         }
 
-        return Rectangle{
+        _bounding_box = Rectangle{
             {min_x, min_y},
             {max_x - min_x, max_y - min_y}
         };
+
+        float n = _vertices.size();
+        _centroid = sum / Vector2f(n, n);
+    }
+
+    void Shape::update_bounds(Vector3f old_position, Vector3f new_position)
+    {
+        const float min_x = _bounding_box.top_left.x,
+                    min_y = _bounding_box.top_left.y,
+                    max_x = _bounding_box.top_left.x + _bounding_box.size.x,
+                    max_y = _bounding_box.top_left.y + _bounding_box.size.y;
+
+        // if the vertex was on the boundary, the aabb may shrink, which can only be decided by looking at all vertices
+        if (old_position.x == min_x or old_position.x == max_x or old_position.y == min_y or old_position.y == max_y)
+        {
+            update_bounds();
+            return;
+        }
+
+        float n = _vertices.size();
+        _centroid.x += (new_position.x - old_position.x) / n;
+        _centroid.y += (new_position.y - old_position.y) / n;
+
+        auto top_left = Vector2f(std::min(min_x, new_position.x), std::min(min_y, new_position.y));
+        auto bottom_right = Vector2f(std::max(max_x, new_position.x), std::max(max_y, new_position.y));
+        _bounding_box = Rectangle{top_left, bottom_right - top_left};
+    }
+
+    void Shape::translate_bounds(Vector2f delta)
+    {
+        _bounding_box.top_left += delta;
+        _centroid += delta;
+    }
+
+    Vector2f Shape::get_centroid() const
+    {
+        return _centroid;
+    }
+
+    void Shape::set_centroid(Vector2f position)
+    {
+        auto delta = position - _centroid;
+        for (auto& v : _vertices)
+        {
+            v.position.x += delta.x;
+            v.position.y += delta.y;
+        }
+
+        translate_bounds(delta);
+        update_positions();
+    }
+
+    Rectangle Shape::get_bounding_box() const
+    {
+        return _bounding_box;
     }
 
     void Shape::align_texture_rectangle_with_bounding_box()
@@ -303,18 +468,25 @@ namespace rat
         set_texture_rectangle(Rectangle{{0, 0}, {1, 1}});
     }
 
+    Rectangle Shape::get_texture_rectangle() const
+    {
+        return _texture_rect;
+    }
+
     void Shape::set_texture_rectangle(Rectangle normalized)
     {
-        auto aabb = get_bounding_box();
+        _texture_rect = normalized;
+
+        const auto& aabb = _bounding_box;
         for (auto& v : _vertices)
         {
             // scale into [0, 1]
-            v.texture_coordinates.x = 1 - (v.position.x - aabb.top_left.x) / aabb.size.x;
+            v.texture_coordinates.x = (v.position.x - aabb.top_left.x) / aabb.size.x;
             v.texture_coordinates.y = (v.position.y - aabb.top_left.y) / aabb.size.y;
 
             // scale into correct size
-            v.texture_coordinates.x *= (normalized.size.x - normalized.top_left.x);
-            v.texture_coordinates.y *= (normalized.size.y - normalized.top_left.y);
+            v.texture_coordinates.x *= normalized.size.x;
+            v.texture_coordinates.y *= normalized.size.y;
 
             // anchor at correct top left
             v.texture_coordinates.x += normalized.top_left.x;
@@ -325,23 +497,24 @@ namespace rat
 
     Vector2f Shape::get_top_left() const
     {
-        return get_bounding_box().top_left;
+        return _bounding_box.top_left;
     }
 
     Vector2f Shape::get_size() const
     {
-        return get_bounding_box().size;
+        return _bounding_box.size;
     }
 
     void Shape::set_top_left(Vector2f position)
     {
-        auto delta = position - get_bounding_box().top_left;
+        auto delta = position - _bounding_box.top_left;
         for (auto& v : _vertices)
         {
             v.position.x += delta.x;
             v.position.y += delta.y;
         }
 
+        translate_bounds(delta);
         update_positions();
     }
 
@@ -353,6 +526,7 @@ namespace rat
             v.position.y += y;
         }
 
+        translate_bounds(Vector2f(x, y));
         update_positions();
     }
 
@@ -374,7 +548,9 @@ namespace rat
 
     void Shape::set_vertex_position(size_t i, Vector3f position)
     {
+        auto old_position = _vertices.at(i).position;
         _vertices.at(i).position = position;
+        update_bounds(old_position, position);
         update_positions();
     }
 
@@ -417,6 +593,40 @@ namespace rat
         return _texture;
     }
 
+    void Shape::set_texture(Texture* texture)
+    {
+        _texture = texture;
+    }
+
+    void Shape::set_layer(size_t layer)
+    {
+        _layer = std::min(layer, max_layer);
+
+        const float depth = layer_to_gl_depth(_layer);
+        for (auto& v : _vertices)
+            v.position.z = depth;
+
+        update_positions();
+    }
+
+    size_t Shape::get_layer() const
+    {
+        return _layer;
+    }
+
+    bool Shape::is_opaque() const
+    {
+        return _texture == nullptr and _all_vertices_opaque;
+    }
+
+    GLNativeHandle Shape::get_native_texture_handle() const
+    {
+        if (_texture == nullptr or not _texture->valid())
+            return 0;
+
+        return _texture->get_native_handle();
+    }
+
     void Shape::set_origin(Vector2f relative_to_centroid)
     {
         _origin = relative_to_centroid;
@@ -440,6 +650,7 @@ namespace rat
             v.position.x = center.x + cos(angle_rad) * distance * x_factor;
             v.position.y = center.y + sin(angle_rad) * distance * y_factor;
         }
+        update_bounds();
         update_positions();
         }
 
@@ -472,7 +683,12 @@ namespace rat
 
     void Shape::initialize()
     {
+        const float depth = layer_to_gl_depth(_layer);
+        for (auto& v : _vertices)
+            v.position.z = depth;
+
         // order matters:
+        update_bounds();
         update_positions();
         update_colors();
         align_texture_rectangle_with_bounding_box();
@@ -489,7 +705,6 @@ namespace rat
             Vertex{{top_left.x, top_left.y + size.y, _default_z}, {0, 1}, _default_color}
         };
         _indices = {0, 1, 3, 1, 2, 3};
-        _render_type = GL_TRIANGLE_FAN;
         initialize();
     }
 
@@ -502,36 +717,78 @@ namespace rat
             Vertex{{c.x, c.y, _default_z}, {0, 0}, _default_color},
         };
         _indices = {0, 1, 2};
-        _render_type = GL_TRIANGLES;
         initialize();
     }
 
-    void Shape::as_line(Vector2f a, Vector2f b)
+    void Shape::as_line(Vector2f a, Vector2f b, float width)
     {
-        _vertices =
-        {
-            Vertex{{a.x, a.y, _default_z}, {0, 0}, _default_color},
-            Vertex{{b.x, b.y, _default_z}, {0, 0}, _default_color}
-        };
-        _indices = {0, 1};
-        _render_type = GL_LINES;
+        as_thick_polyline({a, b}, width, false);
         initialize();
     }
 
+    const Shape::UnitPolygon& Shape::get_unit_polygon(size_t n_vertices)
+    {
+        auto it = _unit_polygon_cache.find(n_vertices);
+        if (it != _unit_polygon_cache.end())
+            return it->second;
+
+        auto polygon = UnitPolygon();
+        polygon.vertices.reserve(n_vertices);
+        polygon.indices.reserve(n_vertices * 3);
+
+        for (size_t i = 0; i < n_vertices; ++i)
+        {
+            // integer step, so the vertex count is exact regardless of float rounding
+            auto as_radians = (2 * M_PI * i) / n_vertices;
+            polygon.vertices.emplace_back(cos(as_radians), sin(as_radians));
+
+            // one triangle per outer edge, outer vertex i is at index i + 1
+            polygon.indices.push_back(0);
+            polygon.indices.push_back(i + 1);
+            polygon.indices.push_back((i + 1) % n_vertices + 1);
+        }
+
+        return _unit_polygon_cache.emplace(n_vertices, std::move(polygon)).first->second;
+    }
+
+    size_t Shape::get_circle_lod(float radius, float zoom, float tolerance)
+    {
+        const size_t min_n = 8,
+                     max_n = 512;
+
+        if (tolerance <= 0)
+            return max_n;
+
+        const float on_screen_radius = radius * zoom;
+        if (on_screen_radius <= tolerance)
+            return min_n;
+
+        // distance between a chord and the arc it spans is r * (1 - cos(pi / n)), solved for n
+        float n = M_PI / std::acos(1 - tolerance / on_screen_radius);
+        auto out = size_t(std::ceil(n / 4.f)) * 4;
+        return std::clamp(out, min_n, max_n);
+    }
+
     void Shape::as_circle(Vector2f center, float radius, size_t n_outer_vertices)
     {
-        const float step = 360.f / n_outer_vertices;
+        if (n_outer_vertices < 3)
+        {
+            std::cerr << "[WARNING] In Shape::as_circle: A circle needs at least 3 outer vertices, got " << n_outer_vertices << ". Using 3 instead." << std::endl;
+            n_outer_vertices = 3;
+        }
+
+        const auto& polygon = get_unit_polygon(n_outer_vertices);
 
         _vertices.clear();
+        _vertices.reserve(n_outer_vertices + 1);
         _vertices.push_back(Vertex{{center.x, center.y, _default_z}, {0, 0}, _default_color});
 
-        for (float angle = 0; angle < 360; angle += step)
+        for (auto& unit : polygon.vertices)
         {
-            auto as_radians = angle * M_PI / 180.f;
             _vertices.push_back(Vertex{
                 {
-                    center.x + cos(as_radians) * radius,
-                    center.y + sin(as_radians) * radius,
+                    center.x + unit.x * radius,
+                    center.y + unit.y * radius,
                     _default_z
                 },
                 {0, 0},
@@ -539,65 +796,312 @@ namespace rat
             );
         }
 
-        _indices.clear();
-        for (size_t i = 0; i < _vertices.size(); ++i)
-            _indices.push_back(i);
+        _indices = polygon.indices;
+        initialize();
+    }
 
-        _indices.push_back(1);
+    void Shape::as_circle(Vector2f center, float radius)
+    {
+        as_circle(center, radius, get_circle_lod(radius));
+    }
 
-        _render_type = GL_TRIANGLE_FAN;
-        initialize();
+    void Shape::as_circle(Vector2f center, float radius, const RenderTarget& target)
+    {
+        // the camera zooms by scaling the global transform, the length of a transformed unit vector is the zoom
+        const auto& matrix = target.get_global_transform().transform;
+        const float zoom = std::max(
+            glm::length(Vector2f(matrix[0][0], matrix[0][1])),
+            glm::length(Vector2f(matrix[1][0], matrix[1][1]))
+        );
+
+        as_circle(center, radius, get_circle_lod(radius, zoom));
     }
 
-    void Shape::as_line_strip(std::vector<Vector2f> positions)
+    void Shape::as_thick_polyline(const std::vector<Vector2f>& in, float width, bool closed)
     {
         _vertices.clear();
         _indices.clear();
 
-        size_t i = 0;
-        for (auto& position : positions)
+        // consecutive duplicates have no direction
+        auto points = std::vector<Vector2f>();
+        points.reserve(in.size());
+        for (auto& point : in)
+            if (points.empty() or point != points.back())
+                points.push_back(point);
+
+        if (closed and points.size() > 1 and points.front() == points.back())
+            points.pop_back();
+
+        const size_t n = points.size();
+        if (n < 2)
         {
+            std::cerr << "[WARNING] In Shape::as_thick_polyline: A line needs at least 2 distinct points, got " << n << "." << std::endl;
+            return;
+        }
+
+        closed = closed and n > 2;
+        const float half_width = width / 2;
+
+        auto normal = [&](size_t from, size_t to) -> Vector2f {
+            auto direction = glm::normalize(points.at(to) - points.at(from));
+            return Vector2f(-direction.y, direction.x);
+        };
+
+        auto push = [&](Vector2f position) {
             _vertices.push_back(Vertex{{position.x, position.y, _default_z}, {0, 0}, _default_color});
-            _indices.push_back(i++);
+        };
+
+        // index of the left vertex of each point for the segment ending and starting there, the right vertex follows
+        // it. They only differ at bevel joins
+        auto in_index = std::vector<uint32_t>(n),
+             out_index = std::vector<uint32_t>(n);
+
+        _vertices.reserve(n * 4);
+        _indices.reserve(n * 9);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            const bool has_previous = closed or i > 0,
+                       has_next = closed or i < n - 1;
+
+            auto in_normal = has_previous ? normal((i + n - 1) % n, i) : normal(i, i + 1);
+            auto out_normal = has_next ? normal(i, (i + 1) % n) : in_normal;
+            auto& point = points.at(i);
+
+            // miter points along the bisector of both normals, lengthened so the edges stay at half_width
+            auto miter = in_normal + out_normal;
+            if (glm::length(miter) > 1e-4)
+            {
+                miter = glm::normalize(miter);
+                float miter_length = half_width / glm::dot(miter, out_normal);
+
+                if (miter_length <= half_width * _miter_limit)
+                {
+                    in_index.at(i) = out_index.at(i) = _vertices.size();
+                    push(point + miter * miter_length);
+                    push(point - miter * miter_length);
+                    continue;
+                }
+            }
+
+            // bevel: both segments keep their full width up to the point, the gap on the outer side is filled by one
+            // triangle. The left side is the outer one if the line turns right
+            in_index.at(i) = _vertices.size();
+            push(point + in_normal * half_width);
+            push(point - in_normal * half_width);
+
+            out_index.at(i) = _vertices.size();
+            push(point + out_normal * half_width);
+            push(point - out_normal * half_width);
+
+            const float turn = in_normal.x * out_normal.y - in_normal.y * out_normal.x;
+            const uint32_t outer = turn > 0 ? 1 : 0;
+
+            for (auto index : {in_index.at(i) + outer, out_index.at(i) + outer, out_index.at(i) + 1 - outer})
+                _indices.push_back(index);
+        }
+
+        const size_t n_segments = closed ? n : n - 1;
+        for (size_t i = 0; i < n_segments; ++i)
+        {
+            uint32_t a = out_index.at(i),
+                     b = in_index.at((i + 1) % n);
+
+            for (auto index : {a, a + 1, b, a + 1, b + 1, b})
+                _indices.push_back(index);
         }
+    }
 
-        _render_type = GL_LINE_STRIP;
+    void Shape::as_line_strip(std::vector<Vector2f> positions, float width)
+    {
+        as_thick_polyline(positions, width, false);
         initialize();
     }
 
-    void Shape::as_wireframe(std::vector<Vector2f> positions)
+    void Shape::as_wireframe(std::vector<Vector2f> positions, float width)
     {
-        _vertices.clear();
-        _indices.clear();
+        as_thick_polyline(sort_by_angle(positions), width, true);
+        initialize();
+    }
 
-        positions = sort_by_angle(positions);
+    std::vector<uint32_t> Shape::triangulate(const std::vector<Vector2f>& points)
+    {
+        auto out = std::vector<uint32_t>();
+        const size_t n = points.size();
+        if (n < 3)
+            return out;
 
-        size_t i = 0;
-        for (auto& position : positions)
+        auto cross = [](Vector2f a, Vector2f b, Vector2f c) -> float {
+            return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        };
+
+        auto is_inside = [&](Vector2f p, Vector2f a, Vector2f b, Vector2f c) -> bool {
+            return cross(a, b, p) >= 0 and cross(b, c, p) >= 0 and cross(c, a, p) >= 0;
+        };
+
+        auto sign = [&](Vector2f a, Vector2f b, Vector2f c) -> int {
+            const float value = cross(a, b, c);
+            return (value > 0) - (value < 0);
+        };
+
+        // only called for collinear points
+        auto is_on_segment = [](Vector2f p, Vector2f a, Vector2f b) -> bool {
+            return std::min(a.x, b.x) <= p.x and p.x <= std::max(a.x, b.x) and std::min(a.y, b.y) <= p.y and p.y <= std::max(a.y, b.y);
+        };
+
+        auto segments_intersect = [&](Vector2f a, Vector2f b, Vector2f c, Vector2f d) -> bool {
+            const int abc = sign(a, b, c),
+                      abd = sign(a, b, d),
+                      cda = sign(c, d, a),
+                      cdb = sign(c, d, b);
+
+            if (abc != abd and cda != cdb)
+                return true;
+
+            return (abc == 0 and is_on_segment(c, a, b)) or (abd == 0 and is_on_segment(d, a, b)) or
+                   (cda == 0 and is_on_segment(a, c, d)) or (cdb == 0 and is_on_segment(b, c, d));
+        };
+
+        // ear clipping assumes a simple polygon, on a self-intersecting one it may emit overlapping triangles
+        for (size_t first = 0; first < n; ++first)
         {
-            _vertices.push_back(Vertex{{position.x, position.y, _default_z}, {0, 0}, _default_color});
-            _indices.push_back(i++);
+            for (size_t second = first + 2; second < n; ++second)
+            {
+                if (first == 0 and second == n - 1) // adjacent through the closing edge
+                    continue;
+
+                if (segments_intersect(points[first], points[(first + 1) % n], points[second], points[(second + 1) % n]))
+                    return out;
+            }
         }
 
-        _render_type = GL_LINE_LOOP;
-        initialize();
+        // walk the outline such that convex corners have a positive cross product, regardless of input winding
+        float area = 0;
+        for (size_t i = 0, j = n - 1; i < n; j = i++)
+            area += points[j].x * points[i].y - points[i].x * points[j].y;
+
+        auto remaining = std::vector<uint32_t>();
+        remaining.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+            remaining.push_back(area > 0 ? i : n - 1 - i);
+
+        out.reserve((n - 2) * 3);
+
+        size_t i = 0,
+               n_failed = 0;
+
+        while (remaining.size() > 3)
+        {
+            const size_t m = remaining.size();
+            const auto previous = remaining[(i + m - 1) % m],
+                       current = remaining[i % m],
+                       next = remaining[(i + 1) % m];
+
+            const auto& a = points[previous];
+            const auto& b = points[current];
+            const auto& c = points[next];
+
+            const float corner = cross(a, b, c);
+            bool is_ear = corner > 0;
+
+            for (size_t j = 0; is_ear and j < m; ++j)
+            {
+                auto other = remaining[j];
+                if (other == previous or other == current or other == next)
+                    continue;
+
+                if (is_inside(points[other], a, b, c))
+                    is_ear = false;
+            }
+
+            // collinear corners are dropped without emitting a triangle
+            if (is_ear or corner == 0)
+            {
+                if (is_ear)
+                {
+                    out.push_back(previous);
+                    out.push_back(current);
+                    out.push_back(next);
+                }
+
+                remaining.erase(remaining.begin() + (i % m));
+                n_failed = 0;
+            }
+            else
+            {
+                i += 1;
+                n_failed += 1;
+
+                // went around the entire outline without finding an ear
+                if (n_failed > m)
+                    return {};
+            }
+        }
+
+        if (cross(points[remaining[0]], points[remaining[1]], points[remaining[2]]) != 0)
+        {
+            out.push_back(remaining[0]);
+            out.push_back(remaining[1]);
+            out.push_back(remaining[2]);
+        }
+
+        return out;
+    }
+
+    std::vector<uint32_t> Shape::get_triangulation(const std::vector<Vector2f>& outline)
+    {
+        if (outline.size() < 3)
+            return {};
+
+        auto relative = std::vector<Vector2f>();
+        relative.reserve(outline.size());
+
+        size_t hash = outline.size();
+        auto combine = [&](float value) {
+            hash ^= std::hash<float>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        };
+
+        for (auto& point : outline)
+        {
+            relative.push_back(point - outline.front());
+            combine(relative.back().x);
+            combine(relative.back().y);
+        }
+
+        auto& bucket = _triangulation_cache[hash];
+        for (auto& entry : bucket)
+            if (entry.outline == relative)
+                return entry.indices;
+
+        if (_triangulation_cache_size >= _max_triangulation_cache_size)
+        {
+            _triangulation_cache.clear();
+            _triangulation_cache_size = 0;
+        }
+
+        auto indices = triangulate(relative);
+        _triangulation_cache[hash].push_back(Triangulation{std::move(relative), indices});
+        _triangulation_cache_size += 1;
+
+        return indices;
     }
 
     void Shape::as_polygon(std::vector<Vector2f> positions)
     {
         _vertices.clear();
-        _indices.clear();
+        _indices = get_triangulation(positions);
 
-        positions = sort_by_angle(positions);
+        // self-intersecting outline, fall back to interpreting the points as a star-shaped polygon
+        if (_indices.empty() and positions.size() >= 3)
+        {
+            positions = sort_by_angle(positions);
+            _indices = get_triangulation(positions);
+        }
 
-        size_t i = 0;
+        _vertices.reserve(positions.size());
         for (auto& position : positions)
-        {
             _vertices.push_back(Vertex{{position.x, position.y, _default_z}, {0, 0}, _default_color});
-            _indices.push_back(i++);
-        }
 
-        _render_type = GL_TRIANGLE_FAN;
         initialize();
     }
 
@@ -643,7 +1147,6 @@ namespace rat
             3, 9, 10, 3, 4, 10
         };
 
-        _render_type = GL_TRIANGLES;
         initialize();
     }
 
@@ -668,17 +1171,24 @@ namespace rat
         return out;
     }
 
-    Shape LineShape(Vector2f a, Vector2f b)
+    Shape CircleShape(Vector2f center, float radius)
+    {
+        auto out = Shape();
+        out.as_circle(center, radius);
+        return out;
+    }
+
+    Shape LineShape(Vector2f a, Vector2f b, float width)
     {
         auto out = Shape();
-        out.as_line(a, b);
+        out.as_line(a, b, width);
         return out;
     }
 
-    Shape LineStripShape(std::vector<Vector2f> vertices)
+    Shape LineStripShape(std::vector<Vector2f> vertices, float width)
     {
         auto out = Shape();
-        out.as_line_strip(vertices);
+        out.as_line_strip(vertices, width);
         return out;
     }
 
@@ -689,10 +1199,10 @@ namespace rat
         return out;
     }
 
-    Shape WireframeShape(std::vector<Vector2f> positions)
+    Shape WireframeShape(std::vector<Vector2f> positions, float width)
     {
         auto out = Shape();
-        out.as_wireframe(positions);
+        out.as_wireframe(positions, width);
         return out;
     }
 
@@ -702,42 +1212,4 @@ namespace rat
         out.as_frame(top_left, size, width);
         return out;
     }
-
-    template<typename Texture_t>
-    void Shape::set_texture(Texture_t texture)
-    {
-        set_texture_aux(texture);
-    }
-
-    template<typename Texture_t, std::enable_if_t<std::is_same_v<Texture_t, StaticTexture>, bool>>
-    void Shape::set_texture_aux(Texture_t* texture)
-    {
-        _texture = texture;
-    }
-
-    template<typename Texture_t, std::enable_if_t<std::is_same_v<Texture_t, DynamicTexture>, bool>>
-    void Shape::set_texture_aux(Texture_t* texture)
-    {
-        _texture = texture;
-    }
-
-    template<typename Texture_t, std::enable_if_t<std::is_same_v<Texture_t, nullptr_t>, bool>>
-    void Shape::set_texture_aux(Texture_t texture)
-    {
-        _texture = texture;
-    }
-
-    template<typename Texture_t, std::enable_if_t<std::is_same_v<Texture_t, RenderTexture>, bool>>
-    void Shape::set_texture_aux(Texture_t* texture)
-    {
-        std::cout << "called" << std::endl;
-        _texture = texture;
-        for (auto& v : _vertices)
-        {
-            v.texture_coordinates.x = v.texture_coordinates.x;
-            v.texture_coordinates.y = 1 - v.texture_coordinates.y;
-        }
-        update_texture_coordinates();
-    }
 }
-
@@ -0,0 +1,174 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/27/22 by clem (mail@clemens-cords.com)
+//
+
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+#include <include/frame_stats.hpp>
+
+namespace rat
+{
+    StreamingBuffer::StreamingBuffer(GLenum target)
+        : _target(target)
+    {}
+
+    StreamingBuffer::~StreamingBuffer()
+    {
+        free();
+    }
+
+    void StreamingBuffer::free()
+    {
+        for (auto& fence : _fences)
+        {
+            if (fence != nullptr)
+            {
+                glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+
+        if (_buffer_id != 0)
+        {
+            if (_mapped != nullptr)
+            {
+                glBindBuffer(_target, _buffer_id);
+                glUnmapBuffer(_target);
+                glBindBuffer(_target, 0);
+            }
+
+            glDeleteBuffers(1, &_buffer_id);
+        }
+
+        _buffer_id = 0;
+        _mapped = nullptr;
+        _region_size = 0;
+        _current_region = 0;
+        _region_offset = 0;
+    }
+
+    void StreamingBuffer::allocate(size_t region_size)
+    {
+        free();
+
+        // leave headroom, so slowly growing data does not reallocate every frame. Regions start 64-byte aligned, so
+        // offsets are valid for any vertex attribute or pixel format
+        _region_size = std::max<size_t>(region_size + region_size / 2, _min_region_size);
+        _region_size = (_region_size + 63) / 64 * 64;
+        const size_t total_size = _region_size * n_regions;
+
+        glGenBuffers(1, &_buffer_id);
+        glBindBuffer(_target, _buffer_id);
+
+        _persistent = GLEW_ARB_buffer_storage;
+
+        if (_persistent)
+        {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(_target, total_size, nullptr, flags);
+            _mapped = glMapBufferRange(_target, 0, total_size, flags);
+
+            if (_mapped == nullptr)
+            {
+                std::cerr << "[WARNING] In StreamingBuffer::allocate: Unable to map buffer persistently, falling back to orphaning." << std::endl;
+                glDeleteBuffers(1, &_buffer_id);
+                glGenBuffers(1, &_buffer_id);
+                glBindBuffer(_target, _buffer_id);
+                _persistent = false;
+            }
+        }
+
+        if (not _persistent)
+            glBufferData(_target, total_size, nullptr, GL_STREAM_DRAW);
+    }
+
+    size_t StreamingBuffer::write(const void* data, size_t n_bytes)
+    {
+        bool next_region = false;
+
+        // each frame starts a new region, grown first if everything written during the last frame did not fit
+        if (_frame != detail::frame_index)
+        {
+            if (_n_bytes_frame > _region_size)
+                allocate(_n_bytes_frame);
+
+            _frame = detail::frame_index;
+            _n_bytes_frame = 0;
+            next_region = true;
+        }
+
+        if (_buffer_id == 0 or n_bytes > _region_size)
+        {
+            allocate(n_bytes);
+            next_region = true;
+        }
+        else
+            glBindBuffer(_target, _buffer_id);
+
+        // if the region overflows, continue in the next one for the rest of the frame
+        if (next_region or _region_offset + n_bytes > _region_size)
+        {
+            _current_region = (_current_region + 1) % n_regions;
+            _region_offset = 0;
+
+            if (_persistent)
+            {
+                // only blocks if the gpu has not yet consumed the region written n_regions frames ago. Fences set
+                // later while the region is filled guard draws of this frame and are not waited on until it is reused
+                auto& fence = _fences.at(_current_region);
+                if (fence != nullptr)
+                {
+                    glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+                    glDeleteSync(fence);
+                    fence = nullptr;
+                }
+            }
+            else
+            {
+                // orphan, the driver hands out fresh storage while the old one is still read
+                glBufferData(_target, _region_size * n_regions, nullptr, GL_STREAM_DRAW);
+            }
+        }
+
+        const size_t offset = _current_region * _region_size + _region_offset;
+
+        // keep offsets 64-byte aligned, like the regions
+        const size_t n_aligned = (n_bytes + 63) / 64 * 64;
+        _region_offset += n_aligned;
+        _n_bytes_frame += n_aligned;
+
+        if (_persistent)
+            std::memcpy(static_cast<char*>(_mapped) + offset, data, n_bytes);
+        else
+            glBufferSubData(_target, offset, n_bytes, data);
+
+        detail::count_buffer_upload(n_bytes);
+        return offset;
+    }
+
+    void StreamingBuffer::fence()
+    {
+        if (not _persistent or _buffer_id == 0)
+            return;
+
+        auto& fence = _fences.at(_current_region);
+        if (fence != nullptr)
+            glDeleteSync(fence);
+
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    GLNativeHandle StreamingBuffer::get_native_handle() const
+    {
+        return _buffer_id;
+    }
+
+    bool StreamingBuffer::is_persistent() const
+    {
+        return _persistent;
+    }
+}
@@ -4,6 +4,7 @@
 //
 
 #include <include/rng.hpp>
+#include <include/profiler.hpp>
 
 namespace rat
 {
@@ -42,48 +43,71 @@ namespace rat
     {
         for (size_t i = 0; i < _glyphs.size(); ++i)
         {
-            if (_visibility_queue.empty() or i < _visibility_queue.front())
+            if (is_glyph_visible(i))
                 _glyphs.at(i)._background_shape.render(target, shader, transform);
         }
 
-        static auto wave_f = [&](float x){
-            x *= _wave_speed_factor;
-            return sin(x * M_PI / 100);
-        };
+        for (size_t i = 0; i < _glyphs.size(); ++i)
+        {
+            if (is_glyph_visible(i))
+                _glyphs.at(i)._shape.render(target, shader, get_glyph_transform(i, transform));
+        }
+    }
 
+    void Text::record(CommandBuffer& buffer, Shader& shader, Transform transform) const
+    {
         for (size_t i = 0; i < _glyphs.size(); ++i)
         {
-            if (not _visibility_queue.empty() and i >= _visibility_queue.front())
-                continue;
+            if (is_glyph_visible(i))
+                _glyphs.at(i)._background_shape.record(buffer, shader, transform);
+        }
 
-            auto current = transform;
-            if (_shake_indices.find(i) != _shake_indices.end())
-            {
-                float x_offset = seed_to_rand(
-                    floor(_shake_offset) + i,
-                    std::min(-(_shake_distance_factor * 0.75) * _font_size, 0.25 * -_shake_distance_factor * 0.5 * _font_size),
-                    std::max(+(_shake_distance_factor * 0.75) * _font_size, 0.25 * +_shake_distance_factor * 0.5 * _font_size)
-                );
+        for (size_t i = 0; i < _glyphs.size(); ++i)
+        {
+            if (is_glyph_visible(i))
+                _glyphs.at(i)._shape.record(buffer, shader, get_glyph_transform(i, transform));
+        }
+    }
 
-                float y_offset = seed_to_rand(
-                    floor(_shake_offset) + i + _glyphs.size(),
-                    std::min(-(_shake_distance_factor * 1.0) * _font_size, 0.25 * -_shake_distance_factor * 1.0 * _font_size),
-                    std::max(+(_shake_distance_factor * 1.0) * _font_size, 0.25 * +_shake_distance_factor * 1.0 * _font_size)
-                );
+    bool Text::is_glyph_visible(size_t i) const
+    {
+        return _visibility_queue.empty() or i < _visibility_queue.front();
+    }
 
-                current.translate(Vector2f(x_offset, y_offset));
-            }
+    Transform Text::get_glyph_transform(size_t i, Transform transform) const
+    {
+        auto wave_f = [this](float x){
+            x *= _wave_speed_factor;
+            return sin(x * M_PI / 100);
+        };
 
-            if (_wave_indices.find(i) != _wave_indices.end())
-            {
-                current.translate(Vector2f(
-                    0,
-                    wave_f(_wave_offset + i) * _wave_distance_factor * _font_size
-                ));
-            }
+        auto current = transform;
+        if (_shake_indices.find(i) != _shake_indices.end())
+        {
+            float x_offset = seed_to_rand(
+                floor(_shake_offset) + i,
+                std::min(-(_shake_distance_factor * 0.75) * _font_size, 0.25 * -_shake_distance_factor * 0.5 * _font_size),
+                std::max(+(_shake_distance_factor * 0.75) * _font_size, 0.25 * +_shake_distance_factor * 0.5 * _font_size)
+            );
+
+            float y_offset = seed_to_rand(
+                floor(_shake_offset) + i + _glyphs.size(),
+                std::min(-(_shake_distance_factor * 1.0) * _font_size, 0.25 * -_shake_distance_factor * 1.0 * _font_size),
+                std::max(+(_shake_distance_factor * 1.0) * _font_size, 0.25 * +_shake_distance_factor * 1.0 * _font_size)
+            );
+
+            current.translate(Vector2f(x_offset, y_offset));
+        }
 
-            _glyphs.at(i)._shape.render(target, shader, current);
+        if (_wave_indices.find(i) != _wave_indices.end())
+        {
+            current.translate(Vector2f(
+                0,
+                wave_f(_wave_offset + i) * _wave_distance_factor * _font_size
+            ));
         }
+
+        return current;
     }
 
     size_t Text::glyph_to_hash(Glyph& glyph)
@@ -140,6 +164,8 @@ namespace rat
 
     void Text::create(RenderTarget& target, Vector2f position, const std::string& formatted_text, size_t width_px, int line_spacer)
     {
+        PROFILE_SCOPE("text.create");
+
         _position = position;
         _width = width_px;
         _line_spacer = line_spacer;
@@ -684,6 +710,9 @@ namespace rat
             glyph._background_shape = glyph._shape;
             glyph._background_shape.set_texture(nullptr);
             glyph._background_shape.set_color(glyph._background_color);
+
+            glyph._shape.set_layer(_layer);
+            glyph._background_shape.set_layer(_layer);
         }
     }
 
@@ -732,8 +761,13 @@ namespace rat
 
     void Text::apply_wrapping()
     {
+        PROFILE_SCOPE("text.apply_wrapping");
+
         if (_glyphs.empty())
+        {
+            _bounding_box = Rectangle{_position, {0, 0}};
             return;
+        }
 
         const auto original_position = _position;
 
@@ -798,6 +832,8 @@ namespace rat
             }
         }
 
+        update_bounding_box();
+
         if (_alignment_type == FLUSH_LEFT)
             return;
 
@@ -834,6 +870,7 @@ namespace rat
                     glyph->set_top_left(glyph->_shape.get_top_left() + Vector2f(offset, 0));
             }
 
+            update_bounding_box();
             return;
         }
 
@@ -868,6 +905,7 @@ namespace rat
                     glyph->set_top_left(glyph->_shape.get_top_left() + Vector2f(offset, 0));
             }
 
+            update_bounding_box();
             return;
         }
 
@@ -955,6 +993,8 @@ namespace rat
                     position.x += free_space_per_word;
                 }
             }
+
+            update_bounding_box();
         }
     }
 
@@ -1021,42 +1061,51 @@ namespace rat
         }
     }
 
-    Rectangle Text::get_bounding_box() const
+    void Text::update_bounding_box()
     {
-        auto out = Rectangle();
-        auto first_glyph = _glyphs.at(0)._shape;
+        if (_glyphs.empty())
+        {
+            _bounding_box = Rectangle{_position, {0, 0}};
+            return;
+        }
 
-        // x bounds
-        float max_x = negative_infinity<float>;
-        float min_x = infinity<float>;
-        float max_y = negative_infinity<float>;
-        float min_y = infinity<float>;
+        float max_x = negative_infinity<float>,
+              min_x = infinity<float>,
+              max_y = negative_infinity<float>,
+              min_y = infinity<float>;
 
         for (auto& glyph : _glyphs)
         {
-            max_x = std::max(max_x, glyph._shape.get_top_left().x + glyph._shape.get_size().x);
-            min_x = std::min(min_x, glyph._shape.get_top_left().x);
-            max_y = std::max(max_y, glyph._shape.get_top_left().y + glyph._shape.get_size().y);
-            min_y = std::min(min_y, glyph._shape.get_top_left().y);
+            const auto top_left = glyph._shape.get_top_left();
+            const auto size = glyph._shape.get_size();
+
+            max_x = std::max(max_x, top_left.x + size.x);
+            min_x = std::min(min_x, top_left.x);
+            max_y = std::max(max_y, top_left.y + size.y);
+            min_y = std::min(min_y, top_left.y);
         }
 
-        out.size.x = max_x - min_x;
-        out.size.y = max_y - min_y;
-        out.top_left.x = min_x;
-        out.top_left.y = min_y;
+        _bounding_box.size.x = max_x - min_x;
+        _bounding_box.size.y = max_y - min_y;
+        _bounding_box.top_left.x = min_x;
+        _bounding_box.top_left.y = min_y;
+    }
 
-        return out;
+    Rectangle Text::get_bounding_box() const
+    {
+        return _bounding_box;
     }
 
     Vector2f Text::get_size() const
     {
-        return get_bounding_box().size;
+        return _bounding_box.size;
     }
 
     void Text::set_top_left(Vector2f position)
     {
         auto offset = position - _glyphs.at(0)._shape.get_top_left();
         _position += offset;
+        _bounding_box.top_left += offset;
         for (auto& glyph : _glyphs)
         {
             auto current_pos = glyph._shape.get_top_left();
@@ -1071,9 +1120,10 @@ namespace rat
 
     void Text::set_centroid(Vector2f position)
     {
-        const auto aabb = get_bounding_box();
+        const auto aabb = _bounding_box;
         auto offset = position - (aabb.top_left + aabb.size * Vector2f(0.5, 0.5));
         _position += offset;
+        _bounding_box.top_left += offset;
 
         for (auto& glyph : _glyphs)
         {
@@ -1084,10 +1134,25 @@ namespace rat
 
     Vector2f Text::get_centroid() const
     {
-        const auto aabb = get_bounding_box();
+        const auto& aabb = _bounding_box;
         return aabb.top_left + aabb.size * Vector2f(0.5, 0.5);
     }
 
+    void Text::set_layer(size_t layer)
+    {
+        _layer = std::min(layer, max_layer);
+        for (auto& glyph : _glyphs)
+        {
+            glyph._shape.set_layer(_layer);
+            glyph._background_shape.set_layer(_layer);
+        }
+    }
+
+    size_t Text::get_layer() const
+    {
+        return _layer;
+    }
+
     size_t Text::get_n_lines() const
     {
         return _n_lines;
@@ -1101,6 +1166,7 @@ namespace rat
         auto offset = point - center;
         offset.x += aabb.size.x * 0.5;
         _position += offset;
+        _bounding_box.top_left += offset;
         for (auto &glyph: _glyphs)
         {
             auto current_pos = glyph._shape.get_top_left();
@@ -1114,6 +1180,7 @@ namespace rat
         auto center = get_centroid();
         auto offset = point - center;
         _position += offset;
+        _bounding_box.top_left += offset;
 
         for (auto &glyph: _glyphs)
         {
@@ -1129,6 +1196,7 @@ namespace rat
         auto offset = point - center;
         offset.x -= aabb.size.x * 0.5;
         _position += offset;
+        _bounding_box.top_left += offset;
 
         for (auto &glyph: _glyphs)
         {
@@ -6,32 +6,53 @@
 #include <include/render_target.hpp>
 #include <include/image.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+
 namespace rat
 {
-    Texture::Texture(RenderTarget& target)
-        : _renderer(target.get_renderer())
+    Texture::Texture(RenderTarget&)
     {}
 
     Texture::~Texture()
     {
-        if (_initialized && _native != nullptr)
-            SDL_DestroyTexture(_native);
+        if (_native_handle != 0)
+            glDeleteTextures(1, &_native_handle);
     }
 
     Texture::Texture(Texture&& other)
     {
-        _native = other._native;
+        _native_handle = other._native_handle;
+        _size = other._size;
         _initialized = other._initialized;
+        _has_mipmaps = other._has_mipmaps;
         _wrap_mode = other._wrap_mode;
         _filter_mode = other._filter_mode;
 
         other._initialized = false;
-        other._native = nullptr;
+        other._native_handle = 0;
     }
 
-    SDL_Texture* Texture::get_native()
+    Texture& Texture::operator=(Texture&& other)
     {
-        return _native;
+        if (&other == this)
+            return *this;
+
+        if (_native_handle != 0)
+            glDeleteTextures(1, &_native_handle);
+
+        _native_handle = other._native_handle;
+        _size = other._size;
+        _initialized = other._initialized;
+        _has_mipmaps = other._has_mipmaps;
+        _wrap_mode = other._wrap_mode;
+        _filter_mode = other._filter_mode;
+
+        other._initialized = false;
+        other._native_handle = 0;
+        return *this;
     }
 
     WrapMode Texture::get_wrap_mode() const
@@ -42,11 +63,13 @@ namespace rat
     void Texture::set_wrap_mode(WrapMode mode)
     {
         _wrap_mode = mode;
+        apply_parameters();
     }
 
     void Texture::set_filter_mode(FilterMode mode)
     {
         _filter_mode = mode;
+        apply_parameters();
     }
 
     FilterMode Texture::get_filter_mode() const
@@ -59,51 +82,184 @@ namespace rat
         if (not valid())
             return;
 
+        // parameters are part of the texture object and were set by apply_parameters
         glBindTexture(GL_TEXTURE_2D, get_native_handle());
-        //SDL_GL_BindTexture(_native, nullptr, nullptr);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, get_wrap_mode());
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,  get_wrap_mode());
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, get_filter_mode());
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, get_filter_mode());
+        detail::count_texture_bind();
     }
 
-    void Texture::unbind()
+    void Texture::apply_parameters()
     {
         if (not valid())
             return;
 
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GLint previous;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+        glBindTexture(GL_TEXTURE_2D, get_native_handle());
+
+        GLint wrap = _wrap_mode;
+        if (_wrap_mode == WrapMode::ZERO or _wrap_mode == WrapMode::ONE)
+        {
+            float value = _wrap_mode == WrapMode::ONE ? 1 : 0;
+            std::array<float, 4> border = {value, value, value, value};
+            glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border.data());
+            wrap = GL_CLAMP_TO_BORDER;
+        }
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+
+        // GL_CUBIC_IMG is only available on OpenGL ES, cubic falls back to linear
+        GLint min_filter, mag_filter;
+        if (_filter_mode == FilterMode::NEAREST_NEIGHBOUR)
+        {
+            min_filter = _has_mipmaps ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST;
+            mag_filter = GL_NEAREST;
+        }
+        else
+        {
+            min_filter = _has_mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+            mag_filter = GL_LINEAR;
+        }
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
+
+        glBindTexture(GL_TEXTURE_2D, previous);
     }
 
-    bool Texture::valid() const
+    void Texture::generate_mipmaps()
     {
-        return _initialized and _native != nullptr;
+        if (not valid())
+        {
+            std::cerr << "[WARNING] In Texture::generate_mipmaps: Texture has not been created yet." << std::endl;
+            return;
+        }
+
+        GLint previous;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+        glBindTexture(GL_TEXTURE_2D, get_native_handle());
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, previous);
+
+        _has_mipmaps = true;
+        apply_parameters();
     }
 
-    Vector2ui Texture::get_size() const
+    bool Texture::has_mipmaps() const
     {
-        int width, height;
-        SDL_QueryTexture(_native, nullptr, nullptr, &width, &height);
-        return Vector2f(width, height);
+        return _has_mipmaps;
     }
 
-    GLNativeHandle Texture::get_native_handle() const
+    bool Texture::upload(SDL_Surface* surface)
     {
-        if (_native_handle != 0)
-            return _native_handle;
+        if (surface == nullptr)
+            return false;
+
+        // byte-order formats, so the mapping holds regardless of endianness
+        GLenum format;
+        GLint internal_format;
+        size_t bytes_per_pixel;
+
+        // gl skips row padding either by whole pixels, through the row length, or up to the next multiple of 4 bytes,
+        // through the alignment. Surfaces with any other pitch are repacked by the conversion below
+        auto is_padded_to_4 = [](SDL_Surface* surface, size_t bytes_per_pixel) {
+            return size_t(surface->pitch) == (surface->w * bytes_per_pixel + 3) / 4 * 4;
+        };
+
+        const size_t source_bytes_per_pixel = surface->format->BytesPerPixel;
+        const bool can_skip_padding = is_padded_to_4(surface, source_bytes_per_pixel) or surface->pitch % source_bytes_per_pixel == 0;
+
+        SDL_Surface* converted = nullptr;
+        switch (can_skip_padding ? surface->format->format : SDL_PIXELFORMAT_UNKNOWN)
+        {
+            case SDL_PIXELFORMAT_RGBA32:
+                format = GL_RGBA; internal_format = GL_RGBA8; bytes_per_pixel = 4;
+                break;
+            case SDL_PIXELFORMAT_BGRA32:
+                format = GL_BGRA; internal_format = GL_RGBA8; bytes_per_pixel = 4;
+                break;
+            case SDL_PIXELFORMAT_RGB24:
+                format = GL_RGB; internal_format = GL_RGB8; bytes_per_pixel = 3;
+                break;
+            case SDL_PIXELFORMAT_BGR24:
+                format = GL_BGR; internal_format = GL_RGB8; bytes_per_pixel = 3;
+                break;
+            default:
+                converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+                if (converted == nullptr)
+                {
+                    std::cerr << "[WARNING] In Texture::upload: Unable to convert surface: " << SDL_GetError() << std::endl;
+                    return false;
+                }
+
+                surface = converted;
+                format = GL_RGBA; internal_format = GL_RGBA8; bytes_per_pixel = 4;
+        }
+
+        if (_native_handle == 0)
+            glGenTextures(1, &_native_handle);
+
+        GLint previous;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+        glBindTexture(GL_TEXTURE_2D, _native_handle);
+
+        if (SDL_MUSTLOCK(surface))
+            SDL_LockSurface(surface);
+
+        // 3-byte rows are usually padded to 4 bytes, which is not a whole number of pixels
+        if (is_padded_to_4(surface, bytes_per_pixel))
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        else
+        {
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, surface->pitch / bytes_per_pixel);
+        }
+
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, surface->w, surface->h, 0, format, GL_UNSIGNED_BYTE, surface->pixels);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        if (SDL_MUSTLOCK(surface))
+            SDL_UnlockSurface(surface);
+
+        // create_from(AssetFile&) may have limited the level range of this texture object
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+
+        glBindTexture(GL_TEXTURE_2D, previous);
+        detail::count_buffer_upload(surface->pitch * surface->h);
 
-        GLint id;
-        SDL_GL_BindTexture(_native, nullptr, nullptr);
+        _size = Vector2ui(surface->w, surface->h);
+        _has_mipmaps = false;
+        _initialized = true;
+
+        if (converted != nullptr)
+            SDL_FreeSurface(converted);
 
-        glGetIntegerv(GL_TEXTURE_BINDING_2D, &id);
+        apply_parameters();
+        return true;
+    }
 
-        _native_handle = id;
+    void Texture::unbind()
+    {
+        if (not valid())
+            return;
 
-        SDL_GL_UnbindTexture(_native);
         glBindTexture(GL_TEXTURE_2D, 0);
+    }
 
-        return id;
+    bool Texture::valid() const
+    {
+        return _initialized and _native_handle != 0;
+    }
+
+    Vector2ui Texture::get_size() const
+    {
+        return _size;
+    }
+
+    GLNativeHandle Texture::get_native_handle() const
+    {
+        return _native_handle;
     }
 
     // STATIC TEXTURE
@@ -112,27 +268,79 @@ namespace rat
         : Texture(target)
     {}
 
-    void StaticTexture::create_from(SDL_Surface* surface)
+    void StaticTexture::create_from(SDL_Surface* surface, bool generate_mipmaps)
     {
-        _native = SDL_CreateTextureFromSurface(_renderer, surface);
-        _initialized = true;
+        if (not upload(surface))
+        {
+            std::cerr << "[WARNING] In StaticTexture::create_from: Unable to create texture from surface." << std::endl;
+            return;
+        }
+
+        if (generate_mipmaps)
+            Texture::generate_mipmaps();
     }
 
-    void StaticTexture::create_from(Image& image)
+    void StaticTexture::create_from(Image& image, bool generate_mipmaps)
     {
-        auto surface = image.operator SDL_Surface*();
-        _native = SDL_CreateTextureFromSurface(_renderer, surface);
-        _initialized = true;
-        SDL_FreeSurface(surface);
+        create_from(image.operator SDL_Surface*(), generate_mipmaps);
     }
 
-    void StaticTexture::load(const std::string &path)
+    void StaticTexture::load(const std::string &path, bool generate_mipmaps)
     {
-        _native = IMG_LoadTexture(_renderer, path.c_str());
-        if (_native == nullptr)
+        auto* surface = IMG_Load(path.c_str());
+        if (surface == nullptr)
+        {
             std::cerr << "[WARNING] In Texture::load: Unable to load image at " << path << std::endl;
+            return;
+        }
+
+        create_from(surface, generate_mipmaps);
+        SDL_FreeSurface(surface);
+    }
+
+    bool StaticTexture::create_from(const AssetFile& asset)
+    {
+        if (not asset.is_open())
+        {
+            std::cerr << "[WARNING] In StaticTexture::create_from: Asset file is not open." << std::endl;
+            return false;
+        }
+
+        if (_native_handle == 0)
+            glGenTextures(1, &_native_handle);
+
+        GLint previous;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+        glBindTexture(GL_TEXTURE_2D, _native_handle);
+
+        // levels are tightly packed and 64-byte aligned, gl reads them directly out of the page cache
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        for (size_t level = 0; level < asset.get_n_levels(); ++level)
+        {
+            auto size = asset.get_level_size(level);
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, asset.get_level_data(level));
+            detail::count_buffer_upload(asset.get_level_n_bytes(level));
+        }
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, asset.get_n_levels() - 1);
+        glBindTexture(GL_TEXTURE_2D, previous);
 
+        _size = asset.get_size();
+        _has_mipmaps = asset.get_n_levels() > 1;
         _initialized = true;
+
+        apply_parameters();
+        return true;
+    }
+
+    bool StaticTexture::load_asset(const std::string& path)
+    {
+        auto asset = AssetFile();
+        if (not asset.open(path))
+            return false;
+
+        return create_from(asset);
     }
 
     void StaticTexture::create(size_t width, size_t height, RGBA color)
@@ -140,7 +348,6 @@ namespace rat
         auto image = Image();
         image.create(width, height, color);
         create_from(image);
-        _initialized = true;
     }
 
     // DYNAMIC TEXTURE
@@ -151,66 +358,131 @@ namespace rat
 
     void DynamicTexture::create(size_t width, size_t height)
     {
-        _native = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, width, height);
-        if (_native != nullptr)
-            _initialized = true;
-        else
-            std::cerr << "[WARNING] In DynamicTexture::create: Unable to create texture: " << SDL_GetError() << std::endl;
+        if (_native_handle == 0)
+            glGenTextures(1, &_native_handle);
+
+        GLint previous;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+        glBindTexture(GL_TEXTURE_2D, _native_handle);
+
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+
+        glBindTexture(GL_TEXTURE_2D, previous);
+
+        _size = Vector2ui(width, height);
+        _has_mipmaps = false;
+        _initialized = true;
+
+        apply_parameters();
     }
 
     void DynamicTexture::load(const std::string &path)
     {
         auto image = Image();
-        image.load(path);
+        if (not image.load(path)) // already warns
+            return;
 
         create(image.get_size().x, image.get_size().y);
         update(image);
     }
 
-    void DynamicTexture::update(Image &image, Vector2ui top_left)
+    void DynamicTexture::update(const Image& image, Vector2ui top_left)
+    {
+        update(image, {0, 0}, image.get_size(), top_left);
+    }
+
+    void DynamicTexture::update(const Image& image, Vector2ui source_top_left, Vector2ui source_size, Vector2ui top_left)
     {
-        auto size = Texture::get_size();
-        auto image_bounds = image.get_size();
-        if ((image_bounds.x + top_left.x) > size.x or (image_bounds.y + top_left.y) > size.y)
+        auto image_size = image.get_size();
+        if (source_top_left.x >= image_size.x or source_top_left.y >= image_size.y)
         {
-            std::cerr << "[WARNING] In DynamicTexture::update: Selected image region is larger than the texture. Only part of the image will be used for updating." << std::endl;
-            image_bounds.x = size.x - ((image_bounds.x + top_left.x));
-            image_bounds.y = size.y - ((image_bounds.y + top_left.y));
+            std::cerr << "[WARNING] In DynamicTexture::update: Source region lies outside the image." << std::endl;
+            return;
         }
 
-        void* pixels;
-        int pitch;
-        auto rectangle = SDL_Rect();
+        source_size.x = std::min(source_size.x, image_size.x - source_top_left.x);
+        source_size.y = std::min(source_size.y, image_size.y - source_top_left.y);
+
+        const auto* pixels = image.get_row(source_top_left.y).data() + source_top_left.x;
+        update(pixels, image.get_pitch() * sizeof(uint32_t), source_size, top_left);
+    }
 
-        uint32_t format;
-        int texture_width, texture_height;
-        SDL_QueryTexture(_native, &format, nullptr, &texture_width, &texture_height);
+    void DynamicTexture::update(const void* pixels, size_t pitch, Vector2ui size, Vector2ui top_left)
+    {
+        if (not valid())
+        {
+            std::cerr << "[WARNING] In DynamicTexture::update: Texture has not been created yet." << std::endl;
+            return;
+        }
 
-        rectangle.x = top_left.x;
-        rectangle.y = top_left.y;
-        rectangle.w = image_bounds.x;
-        rectangle.h = image_bounds.y;
+        if (pixels == nullptr or size.x == 0 or size.y == 0)
+            return;
 
-        if (SDL_LockTexture(_native, &rectangle, &pixels, &pitch) != 0)
+        if (pitch % 4 != 0 or pitch < size.x * 4)
         {
-            std::cerr << "[WARNING] In DynamicTexture::update: Unable to lock texture: " << SDL_GetError() << std::endl;
+            std::cerr << "[WARNING] In DynamicTexture::update: Pitch " << pitch << " is not a multiple of 4 or shorter than a row." << std::endl;
             return;
         }
 
-        size_t i = 0;
-        for (auto it : image)
+        auto texture_size = Texture::get_size();
+        if (top_left.x >= texture_size.x or top_left.y >= texture_size.y)
+            return;
+
+        if ((size.x + top_left.x) > texture_size.x or (size.y + top_left.y) > texture_size.y)
         {
-            auto color = it.operator RGBA();
+            std::cerr << "[WARNING] In DynamicTexture::update: Selected image region is larger than the texture. Only part of the image will be used for updating." << std::endl;
+            size.x = std::min(size.x, texture_size.x - top_left.x);
+            size.y = std::min(size.y, texture_size.y - top_left.y);
+        }
 
-            ((uint8_t*) pixels)[i+0] = color.r * 255;
-            ((uint8_t*) pixels)[i+1] = color.g * 255;
-            ((uint8_t*) pixels)[i+2] = color.b * 255;
-            ((uint8_t*) pixels)[i+3] = color.a * 255;
+        GLint previous;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+        glBindTexture(GL_TEXTURE_2D, _native_handle);
 
-            i += 4;
+        // gl skips the padding at the end of each row, nothing is repacked
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch / 4);
+
+        const size_t n_bytes = pitch * (size.y - 1) + size.x * 4;
+
+        if (_use_pixel_buffer)
+        {
+            if (_pixel_buffer == nullptr)
+                _pixel_buffer = std::make_unique<StreamingBuffer>(GL_PIXEL_UNPACK_BUFFER);
+
+            // the copy into the buffer does not wait for the gpu, the transfer into the texture is asynchronous
+            auto offset = _pixel_buffer->write(pixels, n_bytes);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, top_left.x, top_left.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(offset));
+            _pixel_buffer->fence();
+
+            // other uploads read from client memory again
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        else
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, top_left.x, top_left.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            detail::count_buffer_upload(n_bytes);
         }
 
-        SDL_UnlockTexture(_native);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+        if (_has_mipmaps)
+            glGenerateMipmap(GL_TEXTURE_2D);
+
+        glBindTexture(GL_TEXTURE_2D, previous);
+    }
+
+    void DynamicTexture::set_use_pixel_buffer(bool b)
+    {
+        _use_pixel_buffer = b;
+        if (not b)
+            _pixel_buffer.reset();
+    }
+
+    bool DynamicTexture::get_use_pixel_buffer() const
+    {
+        return _use_pixel_buffer;
     }
 
     // RENDER TEXTURE
@@ -219,11 +491,161 @@ namespace rat
         : Texture(target), _window(&target)
     {}
 
-    void RenderTexture::create(size_t width, size_t height)
+    RenderTexture::~RenderTexture()
+    {
+        free();
+    }
+
+    void RenderTexture::free()
+    {
+        _download_ring.reset();
+
+        _framebuffers.erase(_framebuffer_id);
+        _framebuffers.erase(_multisample_framebuffer_id);
+
+        if (_framebuffer_id != 0)
+            glDeleteFramebuffers(1, &_framebuffer_id);
+
+        if (_depth_stencil_buffer_id != 0)
+            glDeleteRenderbuffers(1, &_depth_stencil_buffer_id);
+
+        if (_multisample_framebuffer_id != 0)
+            glDeleteFramebuffers(1, &_multisample_framebuffer_id);
+
+        if (_multisample_color_buffer_id != 0)
+            glDeleteRenderbuffers(1, &_multisample_color_buffer_id);
+
+        if (_native_handle != 0)
+            glDeleteTextures(1, &_native_handle);
+
+        _framebuffer_id = 0;
+        _depth_stencil_buffer_id = 0;
+        _multisample_framebuffer_id = 0;
+        _multisample_color_buffer_id = 0;
+        _native_handle = 0;
+        _size = {0, 0};
+        _initialized = false;
+    }
+
+    void RenderTexture::create(size_t width, size_t height, bool depth_stencil, size_t n_samples)
+    {
+        if (_currently_bound)
+            unbind_as_render_target();
+
+        free();
+
+        width = std::max<size_t>(width, 1);
+        height = std::max<size_t>(height, 1);
+
+        GLint max_samples = 0;
+        glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+        if (n_samples > size_t(max_samples))
+        {
+            std::cerr << "[WARNING] In RenderTexture::create: " << n_samples << " msaa samples requested, but only " << max_samples << " are supported." << std::endl;
+            n_samples = max_samples;
+        }
+
+        _n_samples = n_samples;
+        _has_depth_stencil = depth_stencil;
+        _size = Vector2ui(width, height);
+
+        GLint previous_framebuffer;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+        glGenTextures(1, &_native_handle);
+        glBindTexture(GL_TEXTURE_2D, _native_handle);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &_framebuffer_id);
+        _framebuffers.insert(_framebuffer_id);
+        glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer_id);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _native_handle, 0);
+
+        if (_n_samples > 0)
+        {
+            // rendering goes into multisampled storage, the texture only receives the resolved result
+            glGenFramebuffers(1, &_multisample_framebuffer_id);
+            _framebuffers.insert(_multisample_framebuffer_id);
+            glBindFramebuffer(GL_FRAMEBUFFER, _multisample_framebuffer_id);
+
+            glGenRenderbuffers(1, &_multisample_color_buffer_id);
+            glBindRenderbuffer(GL_RENDERBUFFER, _multisample_color_buffer_id);
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, _n_samples, GL_RGBA8, width, height);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _multisample_color_buffer_id);
+        }
+
+        if (_has_depth_stencil)
+        {
+            glGenRenderbuffers(1, &_depth_stencil_buffer_id);
+            glBindRenderbuffer(GL_RENDERBUFFER, _depth_stencil_buffer_id);
+
+            if (_n_samples > 0)
+                glRenderbufferStorageMultisample(GL_RENDERBUFFER, _n_samples, GL_DEPTH24_STENCIL8, width, height);
+            else
+                glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+            // attached to whichever framebuffer is rendered to
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depth_stencil_buffer_id);
+        }
+
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cerr << "[WARNING] In RenderTexture::create: Framebuffer incomplete, status " << status << std::endl;
+            free();
+            return;
+        }
+
+        // sdl coordinates have y pointing down, flip so the top row ends up in texture row 0
+        _flip_transform = Transform();
+        _flip_transform.translate({0, float(height)});
+        _flip_transform.scale(1, -1);
+
+        _initialized = true;
+        _has_mipmaps = false;
+        apply_parameters(); // the default min filter expects mipmaps, so this is needed for sampling to work
+    }
+
+    AsyncDownload RenderTexture::download_async()
+    {
+        if (not valid())
+        {
+            std::cerr << "[WARNING] In RenderTexture::download_async: Trying to download a texture that has not been created yet." << std::endl;
+            return AsyncDownload();
+        }
+
+        if (_currently_bound and _n_samples > 0)
+            std::cerr << "[WARNING] In RenderTexture::download_async: Texture is still bound as a render target, so multisampled content was not resolved yet. Call `unbind_as_render_target` first." << std::endl;
+
+        if (_download_ring == nullptr)
+            _download_ring = std::make_shared<PixelBufferRing>();
+
+        return _download_ring->read(_framebuffer_id, GL_COLOR_ATTACHMENT0, get_size(), false);
+    }
+
+    void RenderTexture::download(Image& image)
+    {
+        download_async().get(image);
+    }
+
+    GLNativeHandle RenderTexture::get_framebuffer_handle() const
+    {
+        return _framebuffer_id;
+    }
+
+    bool RenderTexture::is_render_texture_framebuffer(GLNativeHandle framebuffer)
+    {
+        return framebuffer != 0 and _framebuffers.count(framebuffer) > 0;
+    }
+
+    size_t RenderTexture::get_n_samples() const
     {
-        _native = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, width, height);
-        if (_native != nullptr)
-            _initialized = true;
+        return _n_samples;
     }
 
     SDL_Renderer* RenderTexture::get_renderer()
@@ -233,27 +655,33 @@ namespace rat
 
     Transform RenderTexture::get_global_transform() const
     {
-        return _global_transform;
+        // includes the flip, so renderables drawn with `renderable.render(&texture)` end up upright as well
+        return _flip_transform.combine_with(_global_transform);
     }
 
     void RenderTexture::set_global_transform(Transform transform)
     {
-        _global_transform = transform;
+        // flip is its own inverse, strip it so get and set round-trip
+        _global_transform = _flip_transform.combine_with(transform);
     }
 
     void RenderTexture::bind_as_render_target()
     {
         if (not _initialized)
+        {
             std::cerr << "[WARNING] In RenderTexture::bind_as_render_target: Trying to bind a texture that has not been created yet." << std::endl;
+            return;
+        }
+
+        if (_currently_bound)
+            return;
 
         _previous_viewport_size = get_viewport_size();
-        _previous_transform = _window->get_global_transform();
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_previous_framebuffer);
 
-        auto size = get_size();
-        glViewport(0, 0, size.x, size.y);
-        _window->set_global_transform(_global_transform);
+        glBindFramebuffer(GL_FRAMEBUFFER, _n_samples > 0 ? _multisample_framebuffer_id : _framebuffer_id);
+        glViewport(0, 0, _size.x, _size.y);
 
-        SDL_SetRenderTarget(_window->get_renderer(), get_native());
         _currently_bound = true;
     }
 
@@ -262,8 +690,16 @@ namespace rat
         if (not _currently_bound)
             std::cerr << "[WARNING] In RenderTexture::render: Trying to render to a texture even though it is not currently bounds as a render target. Use `bind_as_render_target` before calling `render`." << std::endl;
 
-        transform = transform.combine_with(_global_transform);
-        renderable->render(_window, shader, transform);
+        renderable->render(this, shader, transform);
+    }
+
+    Transform RenderTexture::combine_transforms(Transform transform, Transform global_transform) const
+    {
+        // renderables compute transform * global, with global = flip * camera. Conjugating the per-call transform with
+        // the flip (its own inverse) gives flip * transform * camera, so vertices are transformed exactly like on a
+        // window and only flipped at the very end. Done here rather than in render, so batched recording and
+        // renderables that compose transforms per child, like Text, get the same result
+        return _flip_transform.combine_with(transform).combine_with(_flip_transform).combine_with(global_transform);
     }
 
     void RenderTexture::clear(RGBA color)
@@ -271,20 +707,27 @@ namespace rat
         if (not _currently_bound)
             std::cerr << "[WARNING] In RenderTexture::clear: Trying to clear a texture even though it is not currently bounds as a render target. Use `bind_as_render_target` before calling `render`." << std::endl;
 
-        SDL_SetRenderDrawColor(_window->get_renderer(), color.r * 255, color.g * 255, color.b * 255, color.a * 255);
-        SDL_RenderClear(_window->get_renderer());
+        glClearColor(color.r, color.g, color.b, color.a);
+        glClearDepth(1);
+        glClearStencil(0);
+        glClear(GL_COLOR_BUFFER_BIT | (_has_depth_stencil ? GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT : 0));
     }
 
     void RenderTexture::unbind_as_render_target()
     {
-        //SDL_GL_SwapWindow(_window->get_native());
-        //SDL_RenderFlush(_window->get_renderer());
-        //SDL_RenderPresent(_window->get_renderer());
+        if (not _currently_bound)
+            return;
+
+        if (_n_samples > 0)
+        {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, _multisample_framebuffer_id);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _framebuffer_id);
+            glBlitFramebuffer(0, 0, _size.x, _size.y, 0, 0, _size.x, _size.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        }
 
+        glBindFramebuffer(GL_FRAMEBUFFER, _previous_framebuffer);
         glViewport(0, 0, _previous_viewport_size.x, _previous_viewport_size.y);
 
-        _window->set_global_transform(_previous_transform);
-        SDL_SetRenderTarget(_window->get_renderer(), nullptr);
         _currently_bound = false;
     }
-}
\ No newline at end of file
+}
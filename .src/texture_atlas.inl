@@ -0,0 +1,520 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/30/22 by clem (mail@clemens-cords.com)
+//
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+namespace rat
+{
+    TextureAtlas::TextureAtlas(RenderTarget& target, size_t padding, size_t max_size)
+        : _padding(padding), _max_size(max_size), _texture(target)
+    {}
+
+    TextureAtlas::~TextureAtlas()
+    {
+        for (auto& entry : _entries)
+            SDL_FreeSurface(entry.surface);
+    }
+
+    void TextureAtlas::add(const std::string& name, Image& image)
+    {
+        SDL_Surface* source = image;
+        if (source == nullptr or source->w == 0 or source->h == 0)
+        {
+            std::cerr << "[WARNING] In TextureAtlas::add: Image `" << name << "` is empty." << std::endl;
+            return;
+        }
+
+        auto* copy = SDL_ConvertSurfaceFormat(source, SDL_PIXELFORMAT_RGBA32, 0);
+        if (copy == nullptr)
+        {
+            std::cerr << "[WARNING] In TextureAtlas::add: Unable to copy image `" << name << "`: " << SDL_GetError() << std::endl;
+            return;
+        }
+
+        for (auto& entry : _entries)
+        {
+            if (entry.name == name)
+            {
+                SDL_FreeSurface(entry.surface);
+                entry.surface = copy;
+                return;
+            }
+        }
+
+        _entries.push_back(Entry{name, copy});
+    }
+
+    bool TextureAtlas::add(const std::string& name, const std::string& path)
+    {
+        auto image = Image();
+        if (not image.load(path)) // already warns
+            return false;
+
+        add(name, image);
+        return true;
+    }
+
+    bool TextureAtlas::skyline_fit(const std::vector<SkylineNode>& skyline, size_t index, Vector2ui size, Vector2ui atlas_size, size_t& y)
+    {
+        const size_t x = skyline.at(index).x;
+        if (x + size.x > atlas_size.x)
+            return false;
+
+        // the cell rests on the highest node it spans
+        y = 0;
+        size_t width_left = size.x;
+        for (size_t i = index; width_left > 0; ++i)
+        {
+            if (i >= skyline.size())
+                return false;
+
+            y = std::max(y, skyline.at(i).y);
+            if (y + size.y > atlas_size.y)
+                return false;
+
+            width_left -= std::min(width_left, skyline.at(i).width);
+        }
+
+        return true;
+    }
+
+    bool TextureAtlas::skyline_pack(const std::vector<Vector2ui>& sizes, Vector2ui atlas_size, std::vector<Vector2ui>& positions)
+    {
+        positions.resize(sizes.size());
+
+        // tallest first, this keeps the skyline flat
+        auto order = std::vector<size_t>(sizes.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b){
+            return sizes.at(a).y != sizes.at(b).y ? sizes.at(a).y > sizes.at(b).y : sizes.at(a).x > sizes.at(b).x;
+        });
+
+        auto skyline = std::vector<SkylineNode>{{0, 0, atlas_size.x}};
+
+        for (size_t i : order)
+        {
+            const auto size = sizes.at(i);
+
+            // bottom-left rule: lowest resulting top edge, ties go to the narrowest node
+            size_t best_index = skyline.size(),
+                   best_bottom = infinity<size_t>,
+                   best_width = infinity<size_t>,
+                   best_y = 0;
+
+            for (size_t node = 0; node < skyline.size(); ++node)
+            {
+                size_t y;
+                if (not skyline_fit(skyline, node, size, atlas_size, y))
+                    continue;
+
+                const size_t bottom = y + size.y;
+                if (bottom < best_bottom or (bottom == best_bottom and skyline.at(node).width < best_width))
+                {
+                    best_index = node;
+                    best_bottom = bottom;
+                    best_width = skyline.at(node).width;
+                    best_y = y;
+                }
+            }
+
+            if (best_index == skyline.size())
+                return false;
+
+            const size_t x = skyline.at(best_index).x;
+            positions.at(i) = Vector2ui(x, best_y);
+
+            // raise the skyline under the new cell, then cut away the nodes it covers
+            skyline.insert(skyline.begin() + best_index, SkylineNode{x, best_y + size.y, size.x});
+
+            for (size_t node = best_index + 1; node < skyline.size();)
+            {
+                auto& current = skyline.at(node);
+                const size_t end = x + size.x;
+
+                if (current.x >= end)
+                    break;
+
+                const size_t shrink = end - current.x;
+                if (shrink >= current.width)
+                {
+                    skyline.erase(skyline.begin() + node);
+                    continue;
+                }
+
+                current.x += shrink;
+                current.width -= shrink;
+                break;
+            }
+
+            for (size_t node = 0; node + 1 < skyline.size();)
+            {
+                if (skyline.at(node).y == skyline.at(node + 1).y)
+                {
+                    skyline.at(node).width += skyline.at(node + 1).width;
+                    skyline.erase(skyline.begin() + node + 1);
+                }
+                else
+                    ++node;
+            }
+        }
+
+        return true;
+    }
+
+    void TextureAtlas::blit_extruded(SDL_Surface* source, Vector2ui position)
+    {
+        SDL_Surface* atlas = _image;
+        auto* destination = static_cast<uint8_t*>(atlas->pixels);
+        const auto* pixels = static_cast<const uint8_t*>(source->pixels);
+
+        const size_t width = source->w,
+                     height = source->h,
+                     padding = _padding;
+
+        auto pixel_at = [&](size_t x, size_t y) -> uint32_t* {
+            return reinterpret_cast<uint32_t*>(destination + y * atlas->pitch) + x;
+        };
+
+        // image rows, extended left and right by repeating the edge pixels
+        for (size_t y = 0; y < height; ++y)
+        {
+            auto* row = pixel_at(position.x, position.y + padding + y);
+            std::memcpy(row + padding, pixels + y * source->pitch, width * 4);
+
+            std::fill(row, row + padding, row[padding]);
+            std::fill(row + padding + width, row + 2 * padding + width, row[padding + width - 1]);
+        }
+
+        // repeat the first and last extended row into the padding above and below
+        const size_t row_size = (width + 2 * padding) * 4;
+        const auto* first = pixel_at(position.x, position.y + padding);
+        const auto* last = pixel_at(position.x, position.y + padding + height - 1);
+
+        for (size_t i = 0; i < padding; ++i)
+        {
+            std::memcpy(pixel_at(position.x, position.y + i), first, row_size);
+            std::memcpy(pixel_at(position.x, position.y + padding + height + i), last, row_size);
+        }
+    }
+
+    bool TextureAtlas::pack(bool generate_mipmaps)
+    {
+        if (_entries.empty())
+        {
+            std::cerr << "[WARNING] In TextureAtlas::pack: No images were added." << std::endl;
+            return false;
+        }
+
+        auto sizes = std::vector<Vector2ui>();
+        size_t area = 0,
+               max_width = 0,
+               max_height = 0;
+
+        for (auto& entry : _entries)
+        {
+            auto size = Vector2ui(entry.surface->w + 2 * _padding, entry.surface->h + 2 * _padding);
+            sizes.push_back(size);
+            area += size.x * size.y;
+            max_width = std::max<size_t>(max_width, size.x);
+            max_height = std::max<size_t>(max_height, size.y);
+        }
+
+        auto next_power_of_two = [](size_t x) -> size_t {
+            size_t out = 1;
+            while (out < x)
+                out <<= 1;
+            return out;
+        };
+
+        // start at the smallest power of two that could hold everything, then grow alternating dimensions
+        auto atlas_size = Vector2ui(
+            next_power_of_two(std::max<size_t>(max_width, std::sqrt(area))),
+            next_power_of_two(max_height)
+        );
+        atlas_size.y = std::max(atlas_size.y, next_power_of_two((area + atlas_size.x - 1) / atlas_size.x));
+
+        auto does_not_fit = [&]() {
+            std::cerr << "[WARNING] In TextureAtlas::pack: Images do not fit into an atlas of size " << _max_size << "x" << _max_size << std::endl;
+            return false;
+        };
+
+        if (max_width > _max_size or max_height > _max_size or area > _max_size * _max_size)
+            return does_not_fit();
+
+        // the starting height assumes a square-ish width, a wider atlas may still fit
+        atlas_size = Vector2ui(std::min(atlas_size.x, _max_size), std::min(atlas_size.y, _max_size));
+
+        auto positions = std::vector<Vector2ui>();
+        while (not skyline_pack(sizes, atlas_size, positions))
+        {
+            if (atlas_size.x >= _max_size and atlas_size.y >= _max_size)
+                return does_not_fit();
+
+            if ((atlas_size.x <= atlas_size.y and atlas_size.x < _max_size) or atlas_size.y >= _max_size)
+                atlas_size.x = std::min(atlas_size.x * 2, _max_size);
+            else
+                atlas_size.y = std::min(atlas_size.y * 2, _max_size);
+        }
+
+        _image.create(atlas_size.x, atlas_size.y, RGBA(0, 0, 0, 0));
+        _regions.clear();
+
+        for (size_t i = 0; i < _entries.size(); ++i)
+        {
+            auto& entry = _entries.at(i);
+            auto position = positions.at(i);
+
+            blit_extruded(entry.surface, position);
+            _regions.insert({entry.name, Rectangle{
+                Vector2f(position.x + _padding, position.y + _padding),
+                Vector2f(entry.surface->w, entry.surface->h)
+            }});
+        }
+
+        _texture.create_from(_image, generate_mipmaps);
+        return true;
+    }
+
+    bool TextureAtlas::has_region(const std::string& name) const
+    {
+        return _regions.find(name) != _regions.end();
+    }
+
+    Rectangle TextureAtlas::get_pixel_region(const std::string& name) const
+    {
+        auto it = _regions.find(name);
+        if (it == _regions.end())
+        {
+            std::cerr << "[WARNING] In TextureAtlas::get_pixel_region: No region named `" << name << "`" << std::endl;
+            return Rectangle{{0, 0}, {0, 0}};
+        }
+
+        return it->second;
+    }
+
+    Rectangle TextureAtlas::get_region(const std::string& name) const
+    {
+        auto it = _regions.find(name);
+        if (it == _regions.end())
+        {
+            std::cerr << "[WARNING] In TextureAtlas::get_region: No region named `" << name << "`" << std::endl;
+            return Rectangle{{0, 0}, {0, 0}};
+        }
+
+        auto size = Vector2f(get_size());
+        return Rectangle{it->second.top_left / size, it->second.size / size};
+    }
+
+    std::vector<std::string> TextureAtlas::get_region_names() const
+    {
+        auto out = std::vector<std::string>();
+        out.reserve(_regions.size());
+        for (auto& pair : _regions)
+            out.push_back(pair.first);
+
+        return out;
+    }
+
+    Vector2ui TextureAtlas::get_size() const
+    {
+        return _image.get_size();
+    }
+
+    StaticTexture& TextureAtlas::get_texture()
+    {
+        return _texture;
+    }
+
+    bool TextureAtlas::save(const std::string& path) const
+    {
+        auto* surface = const_cast<Image&>(_image).operator SDL_Surface*();
+        if (surface == nullptr)
+        {
+            std::cerr << "[WARNING] In TextureAtlas::save: Atlas has not been packed yet." << std::endl;
+            return false;
+        }
+
+        if (IMG_SavePNG(surface, (path + ".png").c_str()) != 0)
+        {
+            std::cerr << "[WARNING] In TextureAtlas::save: Unable to write `" << path << ".png`: " << IMG_GetError() << std::endl;
+            return false;
+        }
+
+        auto file = std::ofstream(path + ".atlas");
+        if (not file.is_open())
+        {
+            std::cerr << "[WARNING] In TextureAtlas::save: Unable to open file at `" << path << ".atlas`" << std::endl;
+            return false;
+        }
+
+        // one region per line, the name goes last so it may contain spaces
+        file << _metadata_header << "\n";
+        file << _padding << "\n";
+
+        for (auto& pair : _regions)
+        {
+            auto& region = pair.second;
+            file << region.top_left.x << " " << region.top_left.y << " " << region.size.x << " " << region.size.y << " " << pair.first << "\n";
+        }
+
+        return file.good();
+    }
+
+    bool TextureAtlas::load(const std::string& path, bool generate_mipmaps)
+    {
+        auto file = std::ifstream(path + ".atlas");
+        if (not file.is_open())
+        {
+            std::cerr << "[WARNING] In TextureAtlas::load: Unable to open file at `" << path << ".atlas`" << std::endl;
+            return false;
+        }
+
+        auto line = std::string();
+        std::getline(file, line);
+        if (line != _metadata_header)
+        {
+            std::cerr << "[WARNING] In TextureAtlas::load: File at `" << path << ".atlas` is not an atlas written by TextureAtlas::save" << std::endl;
+            return false;
+        }
+
+        auto warn_malformed = [&](){
+            std::cerr << "[WARNING] In TextureAtlas::load: File at `" << path << ".atlas` is malformed or truncated" << std::endl;
+            return false;
+        };
+
+        size_t padding;
+        std::getline(file, line);
+        auto parsed = std::from_chars(line.data(), line.data() + line.size(), padding);
+        if (parsed.ec != std::errc() or parsed.ptr != line.data() + line.size())
+            return warn_malformed();
+
+        auto regions = std::map<std::string, Rectangle>();
+        while (std::getline(file, line))
+        {
+            if (line.empty())
+                continue;
+
+            auto stream = std::stringstream(line);
+            auto region = Rectangle();
+            stream >> region.top_left.x >> region.top_left.y >> region.size.x >> region.size.y;
+
+            if (stream.fail())
+                return warn_malformed();
+
+            auto name = std::string();
+            stream.get();
+            std::getline(stream, name);
+
+            regions.insert({name, region});
+        }
+
+        if (not _image.load(path + ".png")) // already warns
+            return false;
+
+        for (auto& pair : regions)
+        {
+            if (not is_region_inside(pair.second, _image.get_size()))
+            {
+                std::cerr << "[WARNING] In TextureAtlas::load: Region `" << pair.first << "` in `" << path << ".atlas` is not a whole-pixel rectangle inside `" << path << ".png`" << std::endl;
+                return false;
+            }
+        }
+
+        _padding = padding;
+        _regions = std::move(regions);
+
+        if (not rebuild_entries()) // already warns
+            return false;
+
+        _texture.create_from(_image, generate_mipmaps);
+        return true;
+    }
+
+    bool TextureAtlas::save_asset(const std::string& path, bool generate_mipmaps) const
+    {
+        if (const_cast<Image&>(_image).operator SDL_Surface*() == nullptr)
+        {
+            std::cerr << "[WARNING] In TextureAtlas::save_asset: Atlas has not been packed yet." << std::endl;
+            return false;
+        }
+
+        return AssetFile::write(path, const_cast<Image&>(_image), generate_mipmaps, _regions);
+    }
+
+    bool TextureAtlas::load_asset(const std::string& path)
+    {
+        auto asset = AssetFile();
+        if (not asset.open(path)) // already warns
+            return false;
+
+        if (asset.get_regions().empty())
+        {
+            std::cerr << "[WARNING] In TextureAtlas::load_asset: File at `" << path << "` holds a texture, not an atlas" << std::endl;
+            return false;
+        }
+
+        // the gpu reads all levels straight from the mapping, only the base level is copied for later packs
+        _texture.create_from(asset);
+        _regions = asset.get_regions();
+
+        auto size = asset.get_size();
+        _image.create(size.x, size.y, RGBA(0, 0, 0, 0));
+
+        SDL_Surface* atlas = _image;
+        const auto* source = static_cast<const uint8_t*>(asset.get_level_data(0));
+        for (size_t y = 0; y < size.y; ++y)
+            std::memcpy(static_cast<uint8_t*>(atlas->pixels) + y * atlas->pitch, source + y * size.x * 4, size.x * 4);
+
+        return rebuild_entries(); // already warns
+    }
+
+    bool TextureAtlas::is_region_inside(const Rectangle& region, Vector2ui size)
+    {
+        // save writes whole pixels, anything else comes from an edited or corrupted file
+        for (float value : {region.top_left.x, region.top_left.y, region.size.x, region.size.y})
+            if (not std::isfinite(value) or value < 0 or std::floor(value) != value)
+                return false;
+
+        return region.top_left.x + region.size.x <= size.x and region.top_left.y + region.size.y <= size.y;
+    }
+
+    bool TextureAtlas::rebuild_entries()
+    {
+        for (auto& entry : _entries)
+            SDL_FreeSurface(entry.surface);
+
+        _entries.clear();
+
+        // keep a copy of each image, so more images can be added and packed later
+        SDL_Surface* atlas = _image;
+        for (auto& pair : _regions)
+        {
+            auto& region = pair.second;
+            auto* copy = SDL_CreateRGBSurfaceWithFormat(0, region.size.x, region.size.y, 32, SDL_PIXELFORMAT_RGBA32);
+            if (copy == nullptr)
+            {
+                std::cerr << "[WARNING] In TextureAtlas::rebuild_entries: Unable to allocate surface for region `" << pair.first << "`: " << SDL_GetError() << std::endl;
+                return false;
+            }
+
+            for (size_t y = 0; y < size_t(region.size.y); ++y)
+            {
+                const auto* source = static_cast<const uint8_t*>(atlas->pixels) + (size_t(region.top_left.y) + y) * atlas->pitch + size_t(region.top_left.x) * 4;
+                std::memcpy(static_cast<uint8_t*>(copy->pixels) + y * copy->pitch, source, size_t(region.size.x) * 4);
+            }
+
+            _entries.push_back(Entry{pair.first, copy});
+        }
+
+        return true;
+    }
+}
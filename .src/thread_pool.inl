@@ -0,0 +1,129 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/31/22 by clem (mail@clemens-cords.com)
+//
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+namespace rat
+{
+    ThreadPool::ThreadPool(size_t n_threads)
+    {
+        if (n_threads == 0)
+            n_threads = std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1; // leave one for the main thread
+
+        _threads.reserve(n_threads);
+        for (size_t i = 0; i < n_threads; ++i)
+            _threads.emplace_back([this](){ work(); });
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            auto lock = std::unique_lock(_mutex);
+            _stop = true;
+        }
+
+        _task_available.notify_all();
+        for (auto& thread : _threads)
+            thread.join();
+    }
+
+    template<typename Function_t>
+    auto ThreadPool::submit(Function_t&& function) -> std::future<std::invoke_result_t<Function_t>>
+    {
+        // std::function needs a copyable target, packaged_task is move-only
+        using Result_t = std::invoke_result_t<Function_t>;
+        auto task = std::make_shared<std::packaged_task<Result_t()>>(std::forward<Function_t>(function));
+        auto future = task->get_future();
+
+        {
+            auto lock = std::unique_lock(_mutex);
+            _queue.emplace_back([task](){ (*task)(); });
+        }
+
+        _task_available.notify_one();
+        return future;
+    }
+
+    void ThreadPool::parallel_for(size_t n, std::function<void(size_t, size_t)> function)
+    {
+        if (n == 0)
+            return;
+
+        const size_t n_chunks = std::min(n, _threads.size() + 1),
+                     chunk_size = (n + n_chunks - 1) / n_chunks;
+
+        auto futures = std::vector<std::future<void>>();
+        futures.reserve(n_chunks);
+
+        for (size_t begin = chunk_size; begin < n; begin += chunk_size)
+        {
+            auto end = std::min(begin + chunk_size, n);
+            futures.push_back(submit([&function, begin, end](){ function(begin, end); }));
+        }
+
+        // the workers reference function, so they are waited for even if the first chunk throws
+        auto error = std::exception_ptr();
+        try
+        {
+            function(0, std::min(chunk_size, n));
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        for (auto& future : futures)
+            future.wait();
+
+        if (error)
+            std::rethrow_exception(error);
+
+        // rethrows exceptions of the workers
+        for (auto& future : futures)
+            future.get();
+    }
+
+    void ThreadPool::wait()
+    {
+        auto lock = std::unique_lock(_mutex);
+        _idle.wait(lock, [this](){ return _queue.empty() and _n_running == 0; });
+    }
+
+    size_t ThreadPool::get_n_threads() const
+    {
+        return _threads.size();
+    }
+
+    void ThreadPool::work()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+
+            {
+                auto lock = std::unique_lock(_mutex);
+                _task_available.wait(lock, [this](){ return _stop or not _queue.empty(); });
+
+                if (_queue.empty()) // only reached when stopping
+                    return;
+
+                task = std::move(_queue.front());
+                _queue.pop_front();
+                _n_running += 1;
+            }
+
+            task();
+
+            {
+                auto lock = std::unique_lock(_mutex);
+                _n_running -= 1;
+                if (_queue.empty() and _n_running == 0)
+                    _idle.notify_all();
+            }
+        }
+    }
+}
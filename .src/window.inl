@@ -3,9 +3,6 @@
 // Created on 6/26/22 by clem (mail@clemens-cords.com)
 //
 
-#include <thread>
-#include <chrono>
-
 namespace rat
 {
     void Window::create(
@@ -26,12 +23,13 @@ namespace rat
         SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 8);
 
         SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+        SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
 
         SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
         SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
         SDL_GL_SetAttribute(SDL_GL_BUFFER_SIZE, 32);
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3); // instanced attributes, glsl 330
 
         SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 
@@ -44,7 +42,15 @@ namespace rat
         if (_window != nullptr)
             SDL_DestroyWindow(_window);
 
-        uint32_t sdl_options = SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN;
+        uint32_t sdl_options = SDL_WINDOW_OPENGL;
+
+        if (options & HIDDEN)
+        {
+            sdl_options |= SDL_WINDOW_HIDDEN;
+            _is_hidden = true;
+        }
+        else
+            sdl_options |= SDL_WINDOW_SHOWN;
 
         if (options & FULLSCREEN)
         {
@@ -97,14 +103,16 @@ namespace rat
             std::cerr << "In Window::create: failed to initialize GLEW: " << SDL_GetError() << std::endl;
 
         SDL_GL_MakeCurrent(_window, _gl_context);
-        _renderer = SDL_CreateRenderer(_window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC |
-                                                    SDL_RENDERER_TARGETTEXTURE);
-        SDL_RenderSetVSync(_renderer, true);
-        SDL_GL_SetSwapInterval(-1);
+        _renderer = SDL_CreateRenderer(_window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
+        set_vsync(true);
 
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+        // equal depth passes, so objects on the same layer are drawn in submission order
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LEQUAL);
+
         _is_open = true;
 
         noop_shader = new Shader();
@@ -210,6 +218,18 @@ namespace rat
         _has_focus = false;
         _has_mouse_focus = false;
 
+        // gpu-side objects have to go before the context
+        _download_ring.reset();
+
+        if (_is_open and _resolve_framebuffer_id != 0)
+        {
+            glDeleteFramebuffers(1, &_resolve_framebuffer_id);
+            glDeleteRenderbuffers(1, &_resolve_renderbuffer_id);
+        }
+
+        _resolve_framebuffer_id = 0;
+        _resolve_renderbuffer_id = 0;
+
         SDL_DestroyWindow(_window);
         SDL_GL_DeleteContext(_gl_context);
         _is_open = false;
@@ -327,8 +347,9 @@ namespace rat
         //SDL_SetRenderDrawColor(_renderer, 0, 0, 0, 255);
         //SDL_RenderClear(_renderer);
 
-        glClear(GL_COLOR_BUFFER_BIT);
         glClearColor(0, 0, 0, 1);
+        glClearDepth(1);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
 
     void Window::flush()
@@ -337,12 +358,100 @@ namespace rat
         //SDL_RenderPresent(_renderer);
 
         SDL_GL_SwapWindow(get_native());
+        PROFILE_FRAME();
+
+        _frame_stats = detail::current_frame_stats;
+        detail::current_frame_stats.reset();
+        detail::frame_index += 1;
     }
 
     void Window::display()
     {
-        static auto clock = Clock();
-        auto delta = seconds(1.f / 60) - clock.restart();
-        std::this_thread::sleep_for(std::chrono::milliseconds((size_t) delta.as_milliseconds()));
+        // with vsync, swapping in flush already blocks until the next refresh
+        if (_vsync_enabled)
+            _frame_limiter.skip();
+        else
+            _frame_limiter.wait();
+    }
+
+    void Window::set_vsync(bool b)
+    {
+        if (SDL_GL_SetSwapInterval(b ? 1 : 0) != 0)
+        {
+            std::cerr << "[WARNING] In Window::set_vsync: Unable to " << (b ? "enable" : "disable") << " vsync: " << SDL_GetError() << std::endl;
+            b = SDL_GL_GetSwapInterval() != 0;
+        }
+
+        _vsync_enabled = b;
+    }
+
+    bool Window::get_vsync() const
+    {
+        return _vsync_enabled;
+    }
+
+    void Window::set_frame_rate_limit(float fps)
+    {
+        _frame_limiter.set_target_frame_rate(fps);
+    }
+
+    float Window::get_frame_rate_limit() const
+    {
+        return _frame_limiter.get_target_frame_rate();
+    }
+
+    const FrameLimiter& Window::get_frame_limiter() const
+    {
+        return _frame_limiter;
+    }
+
+    const FrameStats& Window::get_frame_stats() const
+    {
+        return _frame_stats;
+    }
+
+    AsyncDownload Window::download_async()
+    {
+        if (_download_ring == nullptr)
+            _download_ring = std::make_shared<PixelBufferRing>();
+
+        auto size = get_size();
+
+        GLint n_sample_buffers = 0;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glGetIntegerv(GL_SAMPLE_BUFFERS, &n_sample_buffers);
+
+        if (n_sample_buffers == 0)
+            return _download_ring->read(0, GL_BACK, size);
+
+        // multisampled pixels cannot be read directly, resolve into a single-sampled renderbuffer first
+        if (_resolve_framebuffer_id == 0 or _resolve_size != size)
+        {
+            if (_resolve_framebuffer_id == 0)
+            {
+                glGenFramebuffers(1, &_resolve_framebuffer_id);
+                glGenRenderbuffers(1, &_resolve_renderbuffer_id);
+            }
+
+            glBindRenderbuffer(GL_RENDERBUFFER, _resolve_renderbuffer_id);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y);
+            glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, _resolve_framebuffer_id);
+            glFramebufferRenderbuffer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _resolve_renderbuffer_id);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+            _resolve_size = size;
+        }
+
+        GLint previous_framebuffer;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _resolve_framebuffer_id);
+        glReadBuffer(GL_BACK);
+        glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previous_framebuffer);
+
+        return _download_ring->read(_resolve_framebuffer_id, GL_COLOR_ATTACHMENT0, size);
     }
 }
\ No newline at end of file
@@ -0,0 +1,238 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/28/22 by clem (mail@clemens-cords.com)
+//
+
+#include <mousetrap.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace rat;
+
+// set by CMake, so the default font directory does not depend on the working directory
+#ifndef MOUSETRAP_SOURCE_DIR
+#define MOUSETRAP_SOURCE_DIR "."
+#endif
+
+// usage: mousetrap_bench [output.json] [font directory] [font id]
+// the font directory defaults to resources/fonts in the source tree, text benchmarks are skipped if the font is missing
+// runs without a display: unless SDL_VIDEODRIVER is set, SDLs offscreen driver is used, which together with mesa
+// llvmpipe only needs software OpenGL
+
+class BenchmarkResult
+{
+    public:
+        std::string name;
+        size_t n_iterations;
+        double mean_ms,
+               min_ms,
+               max_ms;
+};
+
+std::vector<BenchmarkResult> results;
+
+// run f n_iterations times after one untimed warm-up run. Each iteration waits for the gpu, so render benchmarks
+// measure the full frame cost. A draw call that fails is usually fast, so OpenGL errors raised during the warm-up
+// are reported, the timings of that benchmark are meaningless then
+void run(const std::string& name, size_t n_iterations, std::function<void()> f)
+{
+    while (glGetError() != GL_NO_ERROR);
+
+    f();
+    glFinish();
+
+    for (GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError())
+        std::cerr << "[WARNING] In run: " << name << " raised OpenGL error 0x" << std::hex << error << std::dec << std::endl;
+
+    auto result = BenchmarkResult{name, n_iterations, 0, infinity<double>, 0};
+    auto clock = Clock();
+
+    for (size_t i = 0; i < n_iterations; ++i)
+    {
+        clock.restart();
+        f();
+        glFinish();
+        double ms = clock.elapsed().as_milliseconds();
+
+        result.mean_ms += ms / n_iterations;
+        result.min_ms = std::min(result.min_ms, ms);
+        result.max_ms = std::max(result.max_ms, ms);
+    }
+
+    std::cerr << "[LOG] " << name << ": " << result.mean_ms << " ms" << std::endl;
+    results.push_back(result);
+}
+
+void bench_shapes(Window& window)
+{
+    for (size_t n : {100, 1000, 10000})
+    {
+        auto shapes = std::vector<Shape>();
+        shapes.reserve(n);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            shapes.push_back(RectangleShape({float(i % 800), float((i * 7) % 600)}, {10, 10}));
+            shapes.back().set_color(RGBA(float(i % 3) / 2, 0.5, 1, 1));
+        }
+
+        run("shapes.render_immediate." + std::to_string(n), 20, [&](){
+            window.clear();
+            for (auto& shape : shapes)
+                shape.render(&window);
+        });
+
+        auto queue = RenderQueue(&window);
+        run("shapes.render_queue." + std::to_string(n), 20, [&](){
+            window.clear();
+            for (auto& shape : shapes)
+                queue.submit(&shape);
+            queue.flush();
+        });
+
+        run("shapes.create." + std::to_string(n), 5, [&](){
+            for (size_t i = 0; i < n; ++i)
+                shapes.at(i).as_circle({float(i % 800), float(i % 600)}, 8);
+        });
+    }
+}
+
+void bench_text(Window& window, const std::string& font_path, const std::string& font_id)
+{
+    if (not std::filesystem::exists(font_path + "/" + font_id + Text::font_regular_suffix + ".ttf"))
+    {
+        std::cerr << "[LOG] font `" << font_id << "` not found in `" << font_path << "`, skipping text benchmarks" << std::endl;
+        return;
+    }
+
+    const std::string word = "lorem <b>ipsum</b> dolor ";
+
+    for (size_t n_words : {4, 64, 512})
+    {
+        auto content = std::string();
+        for (size_t i = 0; i < n_words; ++i)
+            content += word;
+
+        auto text = Text(16, font_id, font_path + "/");
+        const std::string suffix = "." + std::to_string(n_words * word.size());
+
+        run("text.create" + suffix, 5, [&](){
+            text.create(window, {10, 10}, content, 780);
+        });
+
+        run("text.layout" + suffix, 20, [&](){
+            text.set_width(700);
+            text.set_width(780);
+        });
+
+        run("text.render" + suffix, 20, [&](){
+            window.clear();
+            text.render(&window);
+        });
+    }
+}
+
+void bench_image()
+{
+    const size_t size = 1024;
+    auto image = Image();
+
+    run("image.create." + std::to_string(size), 5, [&](){
+        image.create(size, size, RGBA(1, 0, 1, 1));
+    });
+
+    run("image.iterate_read." + std::to_string(size), 5, [&](){
+        float sum = 0;
+        auto end = image.end();
+        for (auto it = image.begin(); it != end; ++it)
+        {
+            RGBA color = it;
+            sum += color.r;
+        }
+
+        volatile float sink = sum;
+        (void) sink;
+    });
+
+    run("image.raw_write." + std::to_string(size), 5, [&](){
+        auto* data = image.data();
+        for (size_t i = 0; i < size * size; ++i)
+            data[i] = 0xFF00FFFF;
+    });
+}
+
+void bench_input()
+{
+    for (size_t n_events : {100, 1000, 10000})
+    {
+        run("input.update." + std::to_string(n_events), 20, [&](){
+            for (size_t i = 0; i < n_events; ++i)
+            {
+                auto event = SDL_Event();
+                event.type = i % 2 == 0 ? SDL_KEYDOWN : SDL_KEYUP;
+                event.key.keysym.sym = SDLK_a + (i / 2) % 26;
+                SDL_PushEvent(&event);
+            }
+            InputHandler::update();
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::string output_path = argc > 1 ? argv[1] : "mousetrap_bench.json";
+    const std::string font_path = argc > 2 ? argv[2] : std::string(MOUSETRAP_SOURCE_DIR) + "/resources/fonts";
+    const std::string font_id = argc > 3 ? argv[3] : "Roboto";
+
+    setenv("SDL_VIDEODRIVER", "offscreen", 0);
+
+    auto window = Window();
+    window.create("mousetrap_bench", 800, 600, HIDDEN);
+    window.set_vsync(false);
+
+    bench_shapes(window);
+    bench_text(window, font_path, font_id);
+    bench_image();
+    bench_input();
+
+    auto file = std::ofstream(output_path);
+    if (not file.is_open())
+    {
+        std::cerr << "[WARNING] In main: Unable to open file at `" << output_path << "`, results were not written" << std::endl;
+        window.close();
+        return 0;
+    }
+
+    auto gl_string = [](GLenum name) -> std::string {
+        auto* str = glGetString(name);
+        return str == nullptr ? "unknown" : (const char*) str;
+    };
+
+    file << "{\n";
+    file << "  \"renderer\": \"" << gl_string(GL_RENDERER) << "\",\n";
+    file << "  \"version\": \"" << gl_string(GL_VERSION) << "\",\n";
+    file << "  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        auto& result = results.at(i);
+        file << (i == 0 ? "\n" : ",\n")
+             << "    {\"name\": \"" << result.name << "\""
+             << ", \"iterations\": " << result.n_iterations
+             << ", \"mean_ms\": " << result.mean_ms
+             << ", \"min_ms\": " << result.min_ms
+             << ", \"max_ms\": " << result.max_ms << "}";
+    }
+
+    file << "\n  ]\n}" << std::endl;
+
+    window.close();
+    return 0;
+}
@@ -0,0 +1,106 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/31/22 by clem (mail@clemens-cords.com)
+//
+
+#include <mousetrap.hpp>
+
+#include <charconv>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace rat;
+
+// usage:
+//      mousetrap_cook texture [--mipmaps] <input image> <output>
+//      mousetrap_cook atlas [--mipmaps] [--padding <n>] <output> <name>=<input image> ...
+//
+// converts images into binary assets that StaticTexture::load_asset and TextureAtlas::load_asset map and upload
+// without decoding. Packing an atlas needs an OpenGL context, it is created offscreen, so no display is required.
+// Errors are reported with a warning and exit code 1, so build scripts stop, see CONTRIBUTING.md
+
+int usage()
+{
+    std::cerr << "usage:\n"
+              << "    mousetrap_cook texture [--mipmaps] <input image> <output>\n"
+              << "    mousetrap_cook atlas [--mipmaps] [--padding <n>] <output> <name>=<input image> ..." << std::endl;
+    return 1;
+}
+
+int cook_texture(const std::vector<std::string>& args, bool generate_mipmaps)
+{
+    if (args.size() != 2)
+        return usage();
+
+    auto image = Image();
+    if (not image.load(args.at(0))) // already warns
+        return 1;
+
+    return AssetFile::write(args.at(1), image, generate_mipmaps) ? 0 : 1;
+}
+
+int cook_atlas(const std::vector<std::string>& args, bool generate_mipmaps, size_t padding)
+{
+    if (args.size() < 2)
+        return usage();
+
+    auto target = OffscreenTarget();
+    if (not target.create(1, 1)) // already warns
+        return 1;
+
+    auto atlas = TextureAtlas(target, padding);
+    for (size_t i = 1; i < args.size(); ++i)
+    {
+        auto& arg = args.at(i);
+        auto separator = arg.find('=');
+        if (separator == std::string::npos or separator == 0)
+        {
+            std::cerr << "[WARNING] In mousetrap_cook: Expected `<name>=<path>`, got `" << arg << "`" << std::endl;
+            return 1;
+        }
+
+        if (not atlas.add(arg.substr(0, separator), arg.substr(separator + 1)))
+            return 1;
+    }
+
+    if (not atlas.pack())
+        return 1;
+
+    return atlas.save_asset(args.at(0), generate_mipmaps) ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+        return usage();
+
+    const std::string mode = argv[1];
+
+    bool generate_mipmaps = false;
+    size_t padding = 2;
+    auto args = std::vector<std::string>();
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--mipmaps")
+            generate_mipmaps = true;
+        else if (arg == "--padding" and i + 1 < argc)
+        {
+            const std::string value = argv[++i];
+            auto parsed = std::from_chars(value.data(), value.data() + value.size(), padding);
+            if (parsed.ec != std::errc() or parsed.ptr != value.data() + value.size())
+                return usage();
+        }
+        else
+            args.push_back(arg);
+    }
+
+    if (mode == "texture")
+        return cook_texture(args, generate_mipmaps);
+    else if (mode == "atlas")
+        return cook_atlas(args, generate_mipmaps, padding);
+    else
+        return usage();
+}
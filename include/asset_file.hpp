@@ -0,0 +1,135 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/31/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <include/geometric_shapes.hpp>
+#include <include/image.hpp>
+#include <include/vector.hpp>
+
+namespace rat
+{
+    /// \brief pixel layout of the levels in a cooked asset
+    enum class AssetPixelFormat : uint32_t
+    {
+        /// \brief 4 bytes per pixel in order r, g, b, a, rows top to bottom without padding
+        RGBA8 = 0
+    };
+
+    /// \brief read-only view of a cooked texture or atlas, memory-mapped so levels can be uploaded without copies
+    /// \note layout, all integers in the byte order of the machine that wrote the file, reading a file written with the
+    /// other byte order fails:
+    ///     header:  magic "MTRP", version, format, width, height, n_levels, n_regions, unused, u64 regions offset
+    ///     levels:  n_levels times u64 offset, u64 n_bytes, u32 width, u32 height
+    ///     pixels:  each level starts at a 64-byte aligned offset
+    ///     regions: n_regions times f32 x, y, width, height in whole pixels inside the base level, u32 name length, name bytes
+    /// Files are written by AssetFile::write or the mousetrap_cook tool
+    class AssetFile
+    {
+        public:
+            /// \brief default ctor, nothing mapped
+            AssetFile();
+
+            /// \brief dtor, unmaps the file
+            ~AssetFile();
+
+            AssetFile(const AssetFile&) = delete;
+            AssetFile& operator=(const AssetFile&) = delete;
+
+            /// \brief map a file and validate its header, unmaps the previous file
+            /// \param path: absolute path
+            /// \returns false if the file could not be mapped or is not a valid asset
+            bool open(const std::string& path);
+
+            /// \brief unmap the file, pointers returned by get_level_data become invalid
+            void close();
+
+            /// \brief get whether a file is mapped
+            /// \returns bool
+            bool is_open() const;
+
+            /// \brief get size of the base level
+            /// \returns size, in pixels
+            Vector2ui get_size() const;
+
+            /// \brief get pixel format of all levels
+            /// \returns format
+            AssetPixelFormat get_format() const;
+
+            /// \brief get number of mip levels, including the base level
+            /// \returns size_t
+            size_t get_n_levels() const;
+
+            /// \brief get size of a mip level
+            /// \param level: 0 for the base level
+            /// \returns size, in pixels
+            Vector2ui get_level_size(size_t level) const;
+
+            /// \brief get pixels of a mip level, pointing directly into the mapping
+            /// \param level: 0 for the base level
+            /// \returns pointer, valid until close is called
+            const void* get_level_data(size_t level) const;
+
+            /// \brief get number of bytes of a mip level
+            /// \param level: 0 for the base level
+            /// \returns size_t
+            size_t get_level_n_bytes(size_t level) const;
+
+            /// \brief get atlas regions stored in the file
+            /// \returns regions in pixels of the base level, empty if the file holds a single texture
+            const std::map<std::string, Rectangle>& get_regions() const;
+
+            /// \brief cook an image into an asset file
+            /// \param path: absolute path of the output
+            /// \param image: base level
+            /// \param generate_mipmaps: if true, all levels down to 1x1 are generated with a box filter
+            /// \param regions: atlas regions in pixels, may be empty
+            /// \returns false if the file could not be written
+            static bool write(const std::string& path, Image&, bool generate_mipmaps = false, const std::map<std::string, Rectangle>& regions = {});
+
+        private:
+            class Header
+            {
+                public:
+                    std::array<char, 4> magic;
+                    uint32_t version,
+                             format,
+                             width,
+                             height,
+                             n_levels,
+                             n_regions,
+                             unused;
+                    uint64_t regions_offset;
+            };
+
+            class Level
+            {
+                public:
+                    uint64_t offset,
+                             n_bytes;
+                    uint32_t width,
+                             height;
+            };
+
+            static inline const std::array<char, 4> _magic = {'M', 'T', 'R', 'P'};
+            static inline const uint32_t _version = 1;
+            static inline const size_t _level_alignment = 64;
+            static inline const uint32_t _max_size = 1 << 16; // per dimension, in pixels
+
+            const uint8_t* _data = nullptr;
+            size_t _n_bytes = 0;
+
+            Header _header;
+            std::vector<Level> _levels;
+            std::map<std::string, Rectangle> _regions;
+    };
+}
+
+#include <.src/asset_file.inl>
@@ -0,0 +1,157 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/31/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <include/image.hpp>
+#include <include/render_target.hpp>
+#include <include/texture.hpp>
+#include <include/thread_pool.hpp>
+#include <include/time.hpp>
+
+namespace rat
+{
+    class AssetLoader;
+
+    /// \brief handle to a texture that is loaded in the background, returned by AssetLoader::load
+    /// \note handles share ownership of the texture, copying a handle is cheap
+    class TextureHandle
+    {
+        friend class AssetLoader;
+
+        public:
+            /// \brief default ctor, invalid handle
+            TextureHandle();
+
+            /// \brief get whether the handle refers to a load request
+            /// \returns false if default constructed
+            bool valid() const;
+
+            /// \brief get whether the texture was uploaded and can be used
+            /// \returns bool
+            bool is_ready() const;
+
+            /// \brief get whether the image could not be loaded, the placeholder is used forever in that case
+            /// \returns bool
+            bool has_failed() const;
+
+            /// \brief get texture to render with
+            /// \returns loaded texture once ready, the loaders placeholder until then, nullptr for an invalid handle
+            Texture* get_texture() const;
+
+            /// \brief get path the texture is loaded from
+            /// \returns path, empty for an invalid handle
+            std::string get_path() const;
+
+        private:
+            enum Status
+            {
+                QUEUED,
+                DECODED,
+                READY,
+                FAILED
+            };
+
+            class State
+            {
+                public:
+                    State(RenderTarget&);
+
+                    std::string path;
+                    bool generate_mipmaps;
+
+                    std::unique_ptr<Image> image; // written by a worker, read by update once DECODED, freed after upload
+                    StaticTexture texture;
+                    Texture* placeholder;
+
+                    std::atomic<Status> status = QUEUED;
+            };
+
+            std::shared_ptr<State> _state;
+    };
+
+    /// \brief decodes image files on worker threads and uploads them on the render thread within a per-frame budget
+    /// \note load never blocks. Call update once per frame on the thread that owns the OpenGL context, it uploads
+    /// decoded images until the byte or time budget is used up, so a level load is spread over several frames instead
+    /// of stalling one. The loader has to outlive all shapes that render its placeholder
+    class AssetLoader
+    {
+        public:
+            /// \brief ctor
+            /// \param target: render target textures are created for
+            /// \param n_threads: number of decoding workers, if 0, one less than the number of hardware threads
+            AssetLoader(RenderTarget&, size_t n_threads = 0);
+
+            /// \brief dtor, skips decoding of images that were not started yet and waits for running ones
+            ~AssetLoader();
+
+            AssetLoader(const AssetLoader&) = delete;
+            AssetLoader& operator=(const AssetLoader&) = delete;
+
+            /// \brief queue an image file for loading
+            /// \param path: absolute path
+            /// \param generate_mipmaps: if true, mipmaps are generated after upload
+            /// \returns handle, the same handle is returned for a path that is still loading or loaded
+            TextureHandle load(const std::string& path, bool generate_mipmaps = false);
+
+            /// \brief upload decoded images, has to be called on the render thread
+            /// \note at least one image is uploaded per call if any is decoded, so progress is made even if a single
+            /// image exceeds the budget
+            /// \returns number of textures that became ready
+            size_t update();
+
+            /// \brief block until every queued image is decoded and uploaded, ignores the budget, e.g. for a loading screen
+            void wait();
+
+            /// \brief set maximum number of bytes uploaded by one call to update
+            /// \param n_bytes: 0 for no limit
+            void set_upload_budget(size_t n_bytes);
+
+            /// \brief set maximum time spent uploading by one call to update
+            /// \param duration: 0 for no limit
+            void set_upload_budget(Time duration);
+
+            /// \brief set image shown by handles that are not ready yet
+            /// \param image: copied into a texture, the default is a single transparent pixel
+            void set_placeholder(Image&);
+
+            /// \brief get texture shown by handles that are not ready yet
+            /// \returns pointer
+            Texture* get_placeholder();
+
+            /// \brief get number of images that are queued, decoding or waiting for upload
+            /// \returns size_t
+            size_t get_n_pending() const;
+
+        private:
+            using State = TextureHandle::State;
+
+            void decode(std::shared_ptr<State>);
+
+            RenderTarget* _target;
+            StaticTexture _placeholder;
+
+            size_t _budget_bytes = 4 * 1024 * 1024;
+            Time _budget_time = milliseconds(2);
+
+            std::map<std::string, std::weak_ptr<State>> _cache;
+
+            mutable std::mutex _decoded_mutex;
+            std::deque<std::shared_ptr<State>> _decoded;
+            std::atomic<size_t> _n_pending = 0;
+            std::atomic<bool> _cancelled = false;
+
+            ThreadPool _pool; // last, so workers are joined before anything they touch is destroyed
+    };
+}
+
+#include <.src/asset_loader.inl>
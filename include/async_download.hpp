@@ -0,0 +1,103 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/29/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <array>
+#include <memory>
+
+#include <.src/include_gl.hpp>
+#include <include/image.hpp>
+#include <include/vector.hpp>
+
+namespace rat
+{
+    class PixelBufferRing;
+
+    /// \brief handle to pixels that are being copied from the gpu, returned by download_async
+    /// \note the copy is queued when the handle is created and only waited on by get, so the gpu is not stalled if
+    /// get is called a few frames later. A handle becomes invalid once its owner issued PixelBufferRing::n_buffers more
+    /// downloads, or when the owner is destroyed
+    class AsyncDownload
+    {
+        friend class PixelBufferRing;
+
+        public:
+            /// \brief default ctor, invalid handle
+            AsyncDownload();
+
+            /// \brief get whether the download can still be retrieved
+            /// \returns false if the handle is default constructed, its buffer was reused or its owner was destroyed
+            bool valid() const;
+
+            /// \brief get whether the gpu finished copying, never blocks
+            /// \returns true if get will not block
+            bool is_ready() const;
+
+            /// \brief block until the gpu finished copying
+            void wait() const;
+
+            /// \brief copy the pixels into an image, blocks if the download is not yet ready
+            /// \param image: reallocated if its size does not match, top-left pixel of the source ends up at (0, 0)
+            /// \returns false if the handle is no longer valid
+            bool get(Image&) const;
+
+            /// \brief get size of the downloaded region
+            /// \returns size, in pixels
+            Vector2ui get_size() const;
+
+        private:
+            AsyncDownload(std::weak_ptr<PixelBufferRing>, size_t slot, size_t generation);
+
+            std::weak_ptr<PixelBufferRing> _ring;
+            size_t _slot = 0,
+                   _generation = 0;
+    };
+
+    /// \brief ring of pixel pack buffers, readbacks are written round-robin
+    /// \note owned by a render target through a std::shared_ptr, so handles can detect its destruction
+    class PixelBufferRing : public std::enable_shared_from_this<PixelBufferRing>
+    {
+        friend class AsyncDownload;
+
+        public:
+            /// \brief number of buffers, a download stays valid for this many subsequent downloads
+            static inline const size_t n_buffers = 3;
+
+            /// \brief default ctor, buffers are allocated on first read
+            PixelBufferRing();
+
+            /// \brief dtor, frees buffers and fences
+            ~PixelBufferRing();
+
+            PixelBufferRing(const PixelBufferRing&) = delete;
+            PixelBufferRing& operator=(const PixelBufferRing&) = delete;
+
+            /// \brief queue a copy of the color attachment of a framebuffer into the next buffer
+            /// \param framebuffer: native framebuffer handle, 0 for the default framebuffer
+            /// \param read_buffer: color buffer to read, e.g. GL_COLOR_ATTACHMENT0 or GL_BACK
+            /// \param size: size of the region to read, starting at (0, 0)
+            /// \param flip_rows: true if the framebuffer stores its bottom row first, as the default framebuffer does
+            /// \returns handle, invalidates the handle returned n_buffers reads ago
+            AsyncDownload read(GLNativeHandle framebuffer, GLenum read_buffer, Vector2ui size, bool flip_rows = true);
+
+        private:
+            class Slot
+            {
+                public:
+                    GLNativeHandle buffer_id = 0;
+                    size_t capacity = 0; // in bytes
+                    GLsync fence = nullptr;
+                    Vector2ui size = {0, 0};
+                    bool flip_rows = true;
+                    size_t generation = 0;
+            };
+
+            std::array<Slot, n_buffers> _slots;
+            size_t _current_slot = 0;
+    };
+}
+
+#include <.src/async_download.inl>
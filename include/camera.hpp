@@ -33,6 +33,10 @@ namespace rat
             /// \param value: zoom where 1 is no zoom, 0.5 is 50% zoom out, 1.5 is 50% zoom in
             void set_zoom(float);
 
+            /// \brief get the camera zoom
+            /// \returns zoom where 1 is no zoom, see set_zoom
+            float get_zoom() const;
+
             /// \brief set the camera rotation
             /// \param value: angle, where 0° or 360° is no rotation, clockwise
             void set_rotation(Angle);
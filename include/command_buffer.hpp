@@ -0,0 +1,145 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/26/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <.src/include_gl.hpp>
+#include <include/renderable.hpp>
+#include <include/render_target.hpp>
+#include <include/shader.hpp>
+#include <include/transform.hpp>
+#include <include/vector.hpp>
+#include <include/common.hpp>
+#include <include/streaming_buffer.hpp>
+
+namespace rat
+{
+    class Texture;
+
+    /// \brief list of draw commands, recorded on any thread and replayed into OpenGL on the render thread
+    /// \note recording performs all cpu-side work (transforming and culling vertices) but does not call into OpenGL.
+    /// Each thread should record into its own buffer. Recorded objects have to stay alive and unmodified until the
+    /// buffer was submitted. On submission, consecutive shapes with the same shader and texture are merged into a
+    /// single draw call.
+    class CommandBuffer
+    {
+        friend class Shape;
+
+        public:
+            /// \brief create the buffer, captures the viewport size and global transform of the target
+            /// \param render_target: target the buffer will be submitted to, has to be called on the render thread
+            CommandBuffer(const RenderTarget*);
+
+            /// \brief record a renderable, thread-safe as long as each thread uses its own buffer
+            /// \param renderable: object to record
+            /// \param shader: shader to use during submission, has to stay alive until submission
+            /// \param transform: transform applied to the objects vertices
+            void record(const Renderable*, Shader& = *noop_shader, Transform = Transform());
+
+            /// \brief record a deferred render call, the renderable will be rendered as-is during submission
+            /// \param renderable: object to render, for renderables that prepare their geometry gpu-side
+            /// \param shader: shader to use during submission
+            /// \param transform: transform handed to the object
+            void record_render_call(const Renderable*, Shader&, Transform);
+
+            /// \brief replay all commands into OpenGL, in the order they were recorded. Has to be called on the render thread
+            void submit() const;
+
+            /// \brief get number of draw calls issued by the last submission, after batching
+            /// \returns size_t
+            size_t get_n_draw_calls() const;
+
+            /// \brief remove all commands, keeps the allocated memory
+            void clear();
+
+            /// \brief get number of recorded commands
+            /// \returns size_t
+            size_t get_n_commands() const;
+
+            /// \brief get number of shapes that were not recorded because they were off-screen
+            /// \returns size_t
+            size_t get_n_culled() const;
+
+            /// \brief enable or disable culling of off-screen geometry, enabled by default
+            /// \param b
+            void set_culling_enabled(bool);
+
+            /// \brief get whether culling is enabled
+            /// \returns bool
+            bool get_culling_enabled() const;
+
+            /// \brief get transform of the render target at the time the buffer was created
+            /// \returns transform
+            Transform get_global_transform() const;
+
+            /// \brief combine a per-call transform with the captured global transform, see RenderTarget::combine_transforms
+            /// \param transform: per-call transform
+            /// \returns transform
+            Transform combine_transforms(Transform) const;
+
+            /// \brief get viewport size at the time the buffer was created
+            /// \returns size, in pixels
+            Vector2f get_viewport() const;
+
+        private:
+            class Command
+            {
+                public:
+                    // geometry command, indexed triangles. Vertex data already appended to the buffer
+                    Texture* texture = nullptr;
+                    const std::vector<uint32_t>* indices = nullptr;
+                    size_t vertex_offset = 0; // in vertices
+
+                    // deferred render call, if set, the above is ignored
+                    const Renderable* renderable = nullptr;
+                    Transform transform;
+
+                    Shader* shader = nullptr;
+            };
+
+            // true if the aabb of positions in [offset, end) is outside of gl screen space
+            bool is_culled(size_t offset) const;
+
+            const RenderTarget* _target;
+            Transform _global_transform;
+            Vector2f _viewport_size;
+
+            bool _culling_enabled = true;
+            size_t _n_culled = 0;
+
+            std::vector<Command> _commands;
+            std::vector<float> _positions,           // in gl coordinates, 3 floats per vertex
+                               _colors,              // 4 floats per vertex
+                               _texture_coordinates; // 2 floats per vertex
+
+            // draw one batch of consecutive geometry commands in [begin, end)
+            void draw_batch(size_t begin, size_t end) const;
+            mutable std::vector<uint32_t> _batch_indices;
+            mutable size_t _n_draw_calls = 0;
+
+            // shared by all buffers, only ever used on the render thread
+            static void initialize_buffers();
+            static inline bool _buffers_initialized = false;
+            static inline GLNativeHandle _vertex_array_id = 0,
+                                         _element_buffer_id = 0;
+
+            // all submissions of a frame append to the same region, see StreamingBuffer
+            static inline std::unique_ptr<StreamingBuffer> _position_buffer,
+                                                           _color_buffer,
+                                                           _texture_coordinate_buffer;
+    };
+
+    /// \brief record renderables in parallel, then submit them in order on the calling thread
+    /// \param render_target: target, has to be called on the render thread
+    /// \param renderables: objects to render, will be split in contiguous slices, one per thread
+    /// \param n_threads: number of threads to record on, including the calling thread
+    /// \param shader: shader used for all renderables
+    void render_in_parallel(const RenderTarget*, const std::vector<const Renderable*>&, size_t n_threads, Shader& = *noop_shader);
+}
+
+#include <.src/command_buffer.inl>
@@ -24,5 +24,5 @@ namespace rat
 
     /// \brief negative infinity for given numeric type
     template<typename T>
-    const T negative_infinity = std::numeric_limits<T>::min();
+    const T negative_infinity = std::numeric_limits<T>::lowest();
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/27/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <functional>
+
+#include <include/time.hpp>
+
+namespace rat
+{
+    /// \brief runs simulation updates at a fixed rate, independent of the rate at which frames are rendered
+    /// \note each call to `step` measures the real time since the last call and runs as many updates as fit into it.
+    /// Time that does not make up a full update is carried over to the next frame, the fraction of an update it
+    /// represents is handed to the render function so it can interpolate between the last two simulation states
+    class FixedTimestepLoop
+    {
+        public:
+            /// \brief construct
+            /// \param timestep: simulated time per update
+            /// \param max_steps_per_frame: maximum number of updates per frame, excess time is dropped
+            FixedTimestepLoop(Time timestep = seconds(1.f / 60), size_t max_steps_per_frame = 5);
+
+            /// \brief set function called for every update
+            /// \param f: function with signature (Time timestep) -> void
+            void set_update_function(std::function<void(Time)>);
+
+            /// \brief set function called once per step, after all updates
+            /// \param f: function with signature (float alpha) -> void, alpha in [0, 1) is the fraction of an update elapsed since the last one
+            void set_render_function(std::function<void(float)>);
+
+            /// \brief run all due updates, then render once
+            /// \returns number of updates run
+            size_t step();
+
+            /// \brief discard accumulated time and restart the clock, for example after a loading screen
+            void reset();
+
+            /// \brief set simulated time per update
+            /// \param timestep
+            void set_timestep(Time);
+
+            /// \brief get simulated time per update
+            /// \returns time
+            Time get_timestep() const;
+
+            /// \brief set maximum number of updates per step, protects against a spiral of ever-longer frames on slow machines
+            /// \param n: at least 1
+            void set_max_steps_per_frame(size_t);
+
+            /// \brief get maximum number of updates per step
+            /// \returns size_t
+            size_t get_max_steps_per_frame() const;
+
+            /// \brief get interpolation factor handed to the render function during the last step
+            /// \returns alpha in [0, 1)
+            float get_alpha() const;
+
+            /// \brief get number of updates run during the last step
+            /// \returns size_t
+            size_t get_n_steps_last_frame() const;
+
+            /// \brief get average number of updates per step, exponential moving average
+            /// \returns float
+            float get_average_steps_per_frame() const;
+
+            /// \brief get total number of updates run since construction
+            /// \returns size_t
+            size_t get_n_steps() const;
+
+            /// \brief get total number of updates that were skipped because the per-step maximum was reached
+            /// \returns size_t
+            size_t get_n_dropped_steps() const;
+
+        private:
+            std::function<void(Time)> _update = [](Time){};
+            std::function<void(float)> _render = [](float){};
+
+            Clock _clock;
+            size_t _timestep_ns;
+            size_t _accumulator_ns = 0;
+            size_t _max_steps_per_frame;
+
+            float _alpha = 0;
+            size_t _n_steps_last_frame = 0,
+                   _n_steps = 0,
+                   _n_dropped_steps = 0;
+
+            float _average_steps_per_frame = 0;
+            static inline const float _average_weight = 0.1;
+    };
+
+    /// \brief linearly interpolate between the previous and current simulation state
+    /// \param previous: state before the last update
+    /// \param current: state after the last update
+    /// \param alpha: interpolation factor, usually rat::FixedTimestepLoop::get_alpha
+    /// \returns interpolated state
+    template<typename T>
+    T interpolate(const T& previous, const T& current, float alpha);
+}
+
+#include <.src/fixed_timestep_loop.inl>
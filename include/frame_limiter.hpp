@@ -0,0 +1,76 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/27/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <chrono>
+
+#include <include/time.hpp>
+
+namespace rat
+{
+    /// \brief blocks at the end of each frame until a target frame duration has passed
+    /// \note waits by sleeping until shortly before the deadline, then spinning for the remainder, as sleep is only
+    /// accurate to about a millisecond on most platforms. Deadlines are advanced by exactly one frame duration, so
+    /// timing error does not accumulate
+    class FrameLimiter
+    {
+        public:
+            /// \brief construct
+            /// \param target_frame_rate: frames per second, or 0 for no limit
+            FrameLimiter(float target_frame_rate = 60);
+
+            /// \brief set target frame rate
+            /// \param fps: frames per second, or 0 for no limit
+            void set_target_frame_rate(float);
+
+            /// \brief get target frame rate
+            /// \returns frames per second, 0 if unlocked
+            float get_target_frame_rate() const;
+
+            /// \brief set how long before the deadline sleeping stops and spinning starts
+            /// \param time: higher values are more accurate but use more cpu, 2ms by default
+            void set_spin_duration(Time);
+
+            /// \brief block until the current frame has used up its duration, then start the next frame
+            /// \returns real duration of the frame that just ended, including the wait
+            Time wait();
+
+            /// \brief start the next frame without waiting, for when something else limits the frame rate, such as vsync
+            /// \returns real duration of the frame that just ended
+            Time skip();
+
+            /// \brief get real duration of the last frame, including the wait
+            /// \returns time
+            Time get_frame_duration() const;
+
+            /// \brief get duration of the last frame, excluding the wait
+            /// \returns time
+            Time get_work_duration() const;
+
+            /// \brief get frame rate, averaged over the last few frames
+            /// \returns frames per second
+            float get_average_frame_rate() const;
+
+        private:
+            using clock = std::chrono::steady_clock;
+
+            Time end_frame(clock::time_point now);
+
+            clock::duration _frame_duration = clock::duration::zero(); // zero if unlocked
+            clock::duration _spin_duration = std::chrono::milliseconds(2);
+
+            clock::time_point _frame_start = clock::now(),
+                              _deadline = clock::now();
+
+            clock::duration _last_frame_duration = clock::duration::zero(),
+                            _last_work_duration = clock::duration::zero();
+
+            float _average_frame_duration = 0; // in seconds, exponential moving average
+            static inline const float _average_weight = 0.1;
+    };
+}
+
+#include <.src/frame_limiter.inl>
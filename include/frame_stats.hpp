@@ -0,0 +1,56 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/28/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <cstddef>
+
+#include <.src/include_gl.hpp>
+
+namespace rat
+{
+    /// \brief OpenGL work issued during one frame, see rat::Window::get_frame_stats
+    class FrameStats
+    {
+        public:
+            /// \brief number of glDraw* calls
+            size_t n_draw_calls = 0;
+
+            /// \brief number of vertices referenced by draw calls, instanced draws count each instance
+            size_t n_vertices = 0;
+
+            /// \brief number of buffer uploads, including glBufferData, glBufferSubData and writes to mapped buffers
+            size_t n_buffer_uploads = 0;
+
+            /// \brief total size of all buffer uploads, in bytes
+            size_t n_bytes_uploaded = 0;
+
+            /// \brief number of texture binds
+            size_t n_texture_binds = 0;
+
+            /// \brief number of times the active shader program changed
+            size_t n_program_switches = 0;
+
+            /// \brief set all counters to 0
+            void reset();
+    };
+
+    namespace detail
+    {
+        // counters of the frame in progress, only modified on the render thread
+        inline FrameStats current_frame_stats;
+        inline GLNativeHandle last_used_program = 0;
+
+        // number of frames presented so far, advanced by Window::flush and OffscreenTarget::flush
+        inline size_t frame_index = 0;
+
+        void count_draw_call(size_t n_vertices);
+        void count_buffer_upload(size_t n_bytes);
+        void count_texture_bind();
+        void count_program_use(GLNativeHandle program_id);
+    }
+}
+
+#include <.src/frame_stats.inl>
@@ -0,0 +1,60 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/28/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <string>
+
+#include <include/renderable.hpp>
+#include <include/frame_stats.hpp>
+#include <include/frame_limiter.hpp>
+#include <include/text.hpp>
+#include <include/time.hpp>
+
+namespace rat
+{
+    /// \brief on-screen display of rat::FrameStats
+    /// \note the text is only recreated every refresh interval, as creating text is far more expensive than any of the
+    /// counters. The overlays own draw calls are included in the next frames stats
+    class FrameStatsOverlay : public Renderable
+    {
+        public:
+            /// \brief construct, loads the font
+            /// \param font_size: size of the font, see rat::Text::Text
+            /// \param font_id: id of the font, see rat::Text::Text
+            /// \param font_path: path to the font directory, see rat::Text::Text
+            FrameStatsOverlay(size_t font_size, const std::string& font_id, const std::string& font_path);
+
+            /// \brief update the displayed values, if the refresh interval has passed
+            /// \param render_target: target whose context the glyph textures are created in
+            /// \param stats: stats to display, usually rat::Window::get_frame_stats
+            /// \param limiter: optional, if set, the frame rate and frame duration are displayed
+            void update(RenderTarget&, const FrameStats&, const FrameLimiter* = nullptr);
+
+            /// \brief set how often the displayed values change
+            /// \param interval
+            void set_refresh_interval(Time);
+
+            /// \brief set top left of the overlay
+            /// \param position: in sdl coordinates
+            void set_position(Vector2f);
+
+            /// \copydoc rat::Renderable::render
+            void render(const RenderTarget*, Shader& = *noop_shader, Transform = Transform()) const override;
+
+            /// \copydoc rat::Renderable::record
+            void record(CommandBuffer&, Shader& = *noop_shader, Transform = Transform()) const override;
+
+        private:
+            Text _text;
+            Vector2f _position = Vector2f(10, 10);
+
+            Clock _refresh_clock;
+            Time _refresh_interval = seconds(0.25);
+            bool _created = false;
+    };
+}
+
+#include <.src/frame_stats_overlay.inl>
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <span>
 #include <vector>
 
 #include <include/colors.hpp>
@@ -52,20 +53,57 @@ namespace rat
             operator SDL_Surface*();
 
             uint32_t* data();
+            const uint32_t* data() const;
+
+            /// \brief get pixels of one row, each pixel holds the bytes r, g, b, a in memory order
+            /// \param y: row index, not bounds checked
+            /// \returns span of get_size().x pixels
+            std::span<uint32_t> get_row(size_t y);
+
+            /// \brief get pixels of one row, each pixel holds the bytes r, g, b, a in memory order
+            /// \param y: row index, not bounds checked
+            /// \returns span of get_size().x pixels
+            std::span<const uint32_t> get_row(size_t y) const;
+
+            /// \brief get distance between the starts of two rows
+            /// \returns number of pixels, at least get_size().x
+            size_t get_pitch() const;
+
+            /// \brief set every pixel to the same color
+            /// \param color
+            void fill(RGBA);
+
+            /// \brief copy another image into this one, without blending
+            /// \param source
+            /// \param top_left: position of the sources top left pixel, may be negative, parts outside this image are skipped
+            void blit(const Image&, Vector2i top_left = {0, 0});
+
+            /// \brief multiply r, g and b of each pixel with its alpha, for blending with GL_ONE, GL_ONE_MINUS_SRC_ALPHA
+            void premultiply_alpha();
+
+            /// \brief copy all pixels into a buffer of another format
+            /// \param format: SDL_PixelFormatEnum, RGBA32 and BGRA32 take a fast path
+            /// \param destination: buffer of at least destination_pitch * get_size().y bytes
+            /// \param destination_pitch: distance between rows of the destination, in bytes
+            /// \returns false if SDL does not support the conversion
+            bool convert_to(uint32_t format, void* destination, size_t destination_pitch) const;
+
+            /// \brief pack a color into a pixel of this images format
+            /// \param color: components are clamped to [0, 1]
+            /// \returns pixel
+            static uint32_t color_to_bit(RGBA);
+
+            /// \brief unpack a pixel of this images format
+            /// \param pixel
+            /// \returns color
+            static RGBA bit_to_color(uint32_t);
 
         private:
             using Value_t = uint32_t;
-            SDL_Surface* _data; // RGBA, 8 bytes per element stored in 32-bit int
+            SDL_Surface* _data = nullptr; // SDL_PIXELFORMAT_RGBA32, bytes are r, g, b, a in memory, so OpenGL can read it as GL_RGBA
 
-            RGBA bit_to_color(Value_t);
-            Value_t color_to_bit(RGBA);
             size_t to_linear_index(size_t, size_t) const;
 
-            static const Value_t r_mask = 0xFF000000;
-            static const Value_t g_mask = 0x00FF0000;
-            static const Value_t b_mask = 0x0000FF00;
-            static const Value_t a_mask = 0x000000FF;
-
             static inline const bool NOT_CONST = false;
             static inline const bool CONST = true;
 
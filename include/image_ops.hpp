@@ -0,0 +1,71 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/31/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <array>
+
+#include <include/image.hpp>
+#include <include/thread_pool.hpp>
+#include <include/vector.hpp>
+
+namespace rat
+{
+    /// \brief filter used by resize
+    enum class ResizeFilter
+    {
+        /// \brief linear interpolation, widened when shrinking so every source pixel contributes
+        BILINEAR,
+
+        /// \brief windowed sinc with 3 lobes, sharper, may ring at hard edges
+        LANCZOS
+    };
+
+    // all operations work on whole rows and split them across the workers of pool, if one is given. Per-pixel channel
+    // operations use SSE2 or, if the cpu supports it, AVX2, with a scalar fallback. Blur and resize accumulate whole
+    // rows at once, so the compiler vectorizes them. Filters treat all four channels the same, so images with
+    // transparency should be premultiplied first to avoid dark fringes
+
+    /// \brief blur with a square window, edges are extended
+    /// \param image: modified in place
+    /// \param radius: the window is 2 * radius + 1 pixels wide, 0 does nothing
+    /// \param pool: [optional] thread pool, if nullptr, runs on the calling thread
+    void box_blur(Image&, size_t radius, ThreadPool* pool = nullptr);
+
+    /// \brief approximate gaussian blur by three box blurs
+    /// \param image: modified in place
+    /// \param sigma: standard deviation, in pixels
+    /// \param pool: [optional] thread pool, if nullptr, runs on the calling thread
+    void gaussian_blur(Image&, float sigma, ThreadPool* pool = nullptr);
+
+    /// \brief resample an image to a new size
+    /// \param source
+    /// \param destination: recreated with the new size, may be the same image as source
+    /// \param size: new size in pixels
+    /// \param filter: [optional] interpolation filter
+    /// \param pool: [optional] thread pool, if nullptr, runs on the calling thread
+    void resize(const Image& source, Image& destination, Vector2ui size, ResizeFilter filter = ResizeFilter::BILINEAR, ThreadPool* pool = nullptr);
+
+    /// \brief shift all colors in HSV space, alpha is kept
+    /// \param image: modified in place
+    /// \param hue_offset: added to the hue, wraps around, 1 is a full turn
+    /// \param saturation_offset: added to the saturation, clamped to [0, 1]
+    /// \param value_offset: added to the value, clamped to [0, 1]
+    /// \param pool: [optional] thread pool, if nullptr, runs on the calling thread
+    void shift_hsv(Image&, float hue_offset, float saturation_offset = 0, float value_offset = 0, ThreadPool* pool = nullptr);
+
+    /// \brief multiply r, g and b of each pixel with its alpha, see Image::premultiply_alpha
+    /// \param image: modified in place
+    /// \param pool: [optional] thread pool, if nullptr, runs on the calling thread
+    void premultiply_alpha(Image&, ThreadPool* pool = nullptr);
+
+    /// \brief reorder the channels of each pixel
+    /// \param image: modified in place
+    /// \param order: for each output channel r, g, b, a the index of the input channel, e.g. {2, 1, 0, 3} swaps r and b
+    /// \param pool: [optional] thread pool, if nullptr, runs on the calling thread
+    void swizzle(Image&, std::array<size_t, 4> order, ThreadPool* pool = nullptr);
+}
+
+#include <.src/image_ops.inl>
@@ -0,0 +1,106 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/29/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <SDL2/SDL_render.h>
+#include <.src/include_gl.hpp>
+
+#include <include/render_target.hpp>
+#include <include/renderable.hpp>
+#include <include/shader.hpp>
+#include <include/image.hpp>
+#include <include/async_download.hpp>
+#include <include/colors.hpp>
+#include <include/vector.hpp>
+
+namespace rat
+{
+    /// \brief render target without a visible window, renders into a framebuffer object
+    /// \note owns a hidden SDL window, which only provides the OpenGL context, no SDL renderer is created. If no
+    /// display is available, SDL's offscreen video driver is used, so rendering works with software OpenGL such as
+    /// mesa llvmpipe
+    class OffscreenTarget : public RenderTarget
+    {
+        public:
+            /// \brief default ctor, call create before rendering
+            OffscreenTarget();
+
+            /// \brief dtor, frees the framebuffer and the context
+            ~OffscreenTarget();
+
+            OffscreenTarget(const OffscreenTarget&) = delete;
+            OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+            /// \brief create context and framebuffer, leaves both bound
+            /// \param width: x-dimension, in pixels
+            /// \param height: y-dimension, in pixels
+            /// \returns true if successful
+            bool create(size_t width, size_t height);
+
+            /// \brief free framebuffer and context
+            void close();
+
+            /// \brief get whether create succeeded and close was not yet called
+            /// \returns bool
+            bool is_open() const;
+
+            /// \brief get size of the framebuffer
+            /// \returns size, in pixels
+            Vector2ui get_size() const;
+
+            /// \brief make the context current and bind the framebuffer, called by clear and render
+            void bind() const;
+
+            /// \brief clear color and depth
+            /// \param color: clear color
+            void clear(RGBA = RGBA(0, 0, 0, 1));
+
+            /// \brief wait for all issued draw calls to finish
+            void flush();
+
+            /// \brief read the framebuffer back into ram, blocks until rendering is done
+            /// \param image: reallocated if its size does not match, top-left pixel of the target ends up at (0, 0)
+            void download(Image&) const;
+
+            /// \brief queue a copy of the framebuffer into ram, without waiting for rendering to finish
+            /// \returns handle, call AsyncDownload::get a few frames later to retrieve the pixels without stalling
+            AsyncDownload download_async();
+
+            /// \brief get native OpenGL handle of the framebuffer object
+            /// \returns handle, 0 if not created
+            GLNativeHandle get_framebuffer_handle() const;
+
+            /// \copydoc rat::RenderTarget::render
+            void render(const Renderable*, Shader& = *noop_shader, Transform = Transform()) const override;
+
+            /// \brief textures are owned by OpenGL, so no SDL renderer is created
+            /// \returns nullptr
+            SDL_Renderer* get_renderer() override;
+
+            /// \copydoc rat::RenderTarget::get_global_transform
+            Transform get_global_transform() const override;
+
+            /// \copydoc rat::RenderTarget::set_global_transform
+            void set_global_transform(Transform) override;
+
+        private:
+            SDL_Window* _window = nullptr;
+            SDL_GLContext _gl_context = nullptr;
+
+            GLNativeHandle _framebuffer_id = 0,
+                           _color_buffer_id = 0,
+                           _depth_buffer_id = 0;
+
+            std::shared_ptr<PixelBufferRing> _download_ring;
+
+            Vector2ui _size = {0, 0};
+            Transform _global_transform;
+
+            bool _is_open = false;
+    };
+}
+
+#include <.src/offscreen_target.inl>
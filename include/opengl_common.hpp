@@ -3,6 +3,8 @@
 // Created on 7/13/22 by clem (mail@clemens-cords.com)
 //
 
+#pragma once
+
 #include <.src/include_gl.hpp>
 #include <include/vector.hpp>
 
@@ -16,11 +18,23 @@ namespace rat
     Vector3f sdl_to_gl_screen_position(Vector3f in);
     Vector3f gl_to_sdl_screen_position(Vector3f in);
 
+    // versions that take the viewport size instead of querying it, these do not call into OpenGL and are thread-safe
+    Vector3f sdl_to_gl_screen_position(Vector3f in, Vector2f viewport_size);
+    Vector3f gl_to_sdl_screen_position(Vector3f in, Vector2f viewport_size);
+
     Vector2f sdl_to_gl_texture_coordinates(Vector2f in);
     Vector2f gl_to_sdl_texture_coordinates(Vector2f in);
 
     Vector2f sdl_to_gl_distance(Vector2f distance);
     Vector2f gl_to_sdl_distance(Vector2f distance);
+
+    /// \brief highest z-layer, layer 0 is the furthest back
+    static inline const size_t max_layer = (1 << 16) - 1;
+
+    /// \brief convert a z-layer to the z-component of a vertex in gl coordinates
+    /// \param layer: in [0, max_layer], higher layers are closer to the camera
+    /// \returns depth in (-1, 1], layer 0 maps to 1
+    float layer_to_gl_depth(size_t layer);
 }
 
 #include <.src/opengl_common.inl>
\ No newline at end of file
@@ -0,0 +1,242 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/27/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include <.src/include_gl.hpp>
+#include <include/renderable.hpp>
+#include <include/render_target.hpp>
+#include <include/shader.hpp>
+#include <include/transform.hpp>
+#include <include/colors.hpp>
+#include <include/vector.hpp>
+
+namespace rat
+{
+    /// \brief shape of the outer end of a line
+    enum class CapType
+    {
+        /// \brief line ends exactly at its end point
+        BUTT = 0,
+
+        /// \brief line is extended by half its width past the end point
+        SQUARE = 1,
+
+        /// \brief half circle around the end point
+        ROUND = 2
+    };
+
+    /// \brief shape of the connection between two segments of the same strip
+    enum class JoinType
+    {
+        /// \brief segments are not connected, leaves a gap on the outside of corners
+        NONE = 0,
+
+        /// \brief circle around the shared point
+        ROUND = 2
+    };
+
+    /// \brief anti-aliased lines of arbitrary width, each segment is expanded into a quad on the gpu
+    /// \note all segments are rendered in a single instanced draw call. Overlapping segments are blended twice, so
+    /// transparent strips may appear darker at their joins
+    class Polyline : public Renderable
+    {
+        public:
+            /// \brief default ctor, no segments
+            Polyline();
+
+            /// \brief dtor, frees gpu-side buffers
+            ~Polyline();
+
+            // prevent sharing of gl buffers
+            Polyline(const Polyline&) = delete;
+            Polyline& operator=(const Polyline&) = delete;
+
+            /// \brief replace all segments with a single strip
+            /// \param points: points in order, in sdl coordinates
+            /// \param closed: if true, the last point is connected to the first
+            void create(const std::vector<Vector2f>& points, bool closed = false);
+
+            /// \brief append a strip, it is not connected to existing strips
+            /// \param points: points in order, in sdl coordinates
+            /// \param color: color of the entire strip
+            /// \param closed: if true, the last point is connected to the first
+            void add_strip(const std::vector<Vector2f>& points, RGBA color = RGBA(1, 1, 1, 1), bool closed = false);
+
+            /// \brief append a single, unconnected segment
+            /// \param a: start, in sdl coordinates
+            /// \param b: end, in sdl coordinates
+            /// \param color: color of the segment
+            void add_segment(Vector2f a, Vector2f b, RGBA color = RGBA(1, 1, 1, 1));
+
+            /// \brief remove all segments, keeps allocated memory
+            void clear();
+
+            /// \brief get number of segments
+            /// \returns size_t
+            size_t get_n_segments() const;
+
+            /// \brief set width of all segments
+            /// \param width: in pixels
+            void set_width(float);
+
+            /// \brief get width
+            /// \returns width, in pixels
+            float get_width() const;
+
+            /// \brief set shape of the outer ends of all strips
+            /// \param type
+            void set_cap_type(CapType);
+
+            /// \brief get cap type
+            /// \returns type
+            CapType get_cap_type() const;
+
+            /// \brief set shape of the connection between segments of a strip
+            /// \param type
+            void set_join_type(JoinType);
+
+            /// \brief get join type
+            /// \returns type
+            JoinType get_join_type() const;
+
+            /// \brief set color of all segments
+            /// \param color
+            void set_color(RGBA);
+
+            /// \brief set z-layer
+            /// \param layer: in [0, max_layer]
+            void set_layer(size_t);
+
+            /// \copydoc rat::Renderable::get_layer
+            size_t get_layer() const override;
+
+            /// \copydoc rat::Renderable::render
+            /// \note the shader argument is ignored, polylines are always rendered with their own program
+            void render(const RenderTarget*, Shader& = *noop_shader, Transform = Transform()) const override;
+
+        private:
+            class Segment
+            {
+                public:
+                    Vector2f a, b;
+                    RGBA color;
+                    bool a_is_end, // a is the start of a strip, and not a join
+                         b_is_end;
+            };
+
+            std::vector<Segment> _segments;
+
+            float _width = 1;
+            CapType _cap_type = CapType::BUTT;
+            JoinType _join_type = JoinType::ROUND;
+            size_t _layer = 0;
+
+            // instance data is rebuilt lazily on render, as segments are usually added one strip at a time
+            void update_instance_data() const;
+            mutable bool _instance_data_dirty = true;
+            mutable std::vector<float> _instance_data; // per segment: vec4 end points, vec4 color, vec2 cap types
+            mutable size_t _instance_buffer_capacity = 0; // in bytes
+
+            GLNativeHandle _vertex_array_id = 0,
+                           _instance_buffer_id = 0;
+
+            static void initialize_shader();
+            static inline Shader* _shader = nullptr;
+
+            static inline const size_t _n_floats_per_instance = 10;
+
+            static inline const std::string _vertex_shader_source = R"(
+                #version 330
+
+                layout (location = 0) in vec4 _segment_in; // a.xy, b.xy, in sdl coordinates
+                layout (location = 1) in vec4 _color_in;
+                layout (location = 2) in vec2 _cap_in;     // cap type at a, cap type at b
+
+                uniform mat4 _transform;
+                uniform vec2 _viewport_size;
+                uniform float _half_width;
+                uniform float _depth;
+
+                out vec4 _vertex_color;
+                out vec2 _texture_coordinates; // position in segment space, in pixels: x along, y across
+                out vec3 _vertex_position;
+                flat out vec4 _segment_info;   // length, half width, cap at a, cap at b
+
+                void main()
+                {
+                    vec2 a = (_transform * vec4(_segment_in.xy, 0, 1)).xy;
+                    vec2 b = (_transform * vec4(_segment_in.zw, 0, 1)).xy;
+
+                    vec2 delta = b - a;
+                    float len = length(delta);
+                    vec2 along = len > 0 ? delta / len : vec2(1, 0);
+                    vec2 across = vec2(-along.y, along.x);
+
+                    // quad covers segment and caps, plus one pixel for anti-aliasing. Corners in triangle strip order
+                    float extent = _half_width + 1;
+                    float x = (gl_VertexID & 1) == 0 ? -extent : len + extent;
+                    float y = (gl_VertexID & 2) == 0 ? -extent : extent;
+
+                    vec2 position = a + along * x + across * y;
+
+                    // same mapping as rat::sdl_to_gl_screen_position
+                    vec2 half_size = _viewport_size / 2;
+                    gl_Position = vec4((position.x + 1 - half_size.x) / half_size.x, (half_size.y - position.y) / half_size.y, _depth, 1);
+
+                    _vertex_color = _color_in;
+                    _texture_coordinates = vec2(x, y);
+                    _vertex_position = gl_Position.xyz;
+                    _segment_info = vec4(len, _half_width, _cap_in);
+                }
+            )";
+
+            static inline const std::string _fragment_shader_source = R"(
+                #version 330
+
+                in vec4 _vertex_color;
+                in vec2 _texture_coordinates;
+                in vec3 _vertex_position;
+                flat in vec4 _segment_info;
+
+                out vec4 _fragment_color;
+
+                void main()
+                {
+                    float len = _segment_info.x;
+                    float half_width = _segment_info.y;
+                    float x = _texture_coordinates.x;
+                    float y = abs(_texture_coordinates.y);
+
+                    // signed distance to the outline of the stroke, negative inside
+                    float distance = y - half_width;
+
+                    if (x < 0 || x > len)
+                    {
+                        float cap = x < 0 ? _segment_info.z : _segment_info.w;
+                        float past_end = x < 0 ? -x : x - len;
+
+                        if (cap > 1.5)       // round
+                            distance = length(vec2(past_end, y)) - half_width;
+                        else if (cap > 0.5)  // square
+                            distance = max(past_end - half_width, y - half_width);
+                        else                 // butt
+                            distance = max(past_end, y - half_width);
+                    }
+
+                    float coverage = clamp(0.5 - distance, 0, 1);
+                    if (coverage <= 0)
+                        discard;
+
+                    _fragment_color = vec4(_vertex_color.rgb, _vertex_color.a * coverage);
+                }
+            )";
+    };
+}
+
+#include <.src/polyline.inl>
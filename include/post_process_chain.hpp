@@ -0,0 +1,160 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/30/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <.src/include_gl.hpp>
+#include <include/render_target.hpp>
+#include <include/renderable.hpp>
+#include <include/shader.hpp>
+#include <include/texture.hpp>
+#include <include/window.hpp>
+
+namespace rat
+{
+    /// \brief chain of full-screen fragment shader passes applied to everything rendered between begin and end
+    /// \note the scene and two ping-pong textures are allocated at window size, and only reallocated if the window
+    /// size changes. Each pass is drawn as a single full-screen triangle, the last enabled pass writes into the
+    /// framebuffer that was bound when begin was called, which may be the window, an OffscreenTarget or a RenderTexture.
+    /// Pass fragment shaders may use:
+    ///     in vec2 _texture_coordinates;   // (0, 0) is the top left
+    ///     uniform sampler2D _texture;     // output of the previous pass, or the scene for the first pass
+    ///     uniform sampler2D _scene;       // scene before any pass
+    ///     uniform vec2 _texture_size;     // in pixels
+    ///     out vec4 _fragment_color;
+    class PostProcessChain : public RenderTarget
+    {
+        public:
+            /// \brief ctor, textures are allocated on first begin
+            /// \param window: window whose size the textures follow
+            /// \param n_samples: msaa samples of the scene texture, 0 to disable
+            PostProcessChain(Window&, size_t n_samples = 0);
+
+            PostProcessChain(const PostProcessChain&) = delete;
+            PostProcessChain& operator=(const PostProcessChain&) = delete;
+
+            /// \brief append a pass
+            /// \param fragment_shader_source: glsl code, see the class description for available inputs
+            /// \returns index of the pass
+            size_t add_pass(const std::string& fragment_shader_source);
+
+            /// \brief append a pass, loading the fragment shader from disk
+            /// \param path: absolute path to glsl file
+            /// \returns index of the pass
+            size_t add_pass_from_file(const std::string& path);
+
+            /// \brief get shader of a pass, for example to set custom uniforms
+            /// \param index: index of the pass
+            /// \returns reference to shader
+            Shader& get_pass_shader(size_t);
+
+            /// \brief enable or disable a pass, disabled passes are skipped without reallocation
+            /// \param index: index of the pass
+            /// \param b: true if enabled
+            void set_pass_enabled(size_t, bool);
+
+            /// \brief get whether a pass is enabled
+            /// \param index: index of the pass
+            /// \returns bool
+            bool get_pass_enabled(size_t) const;
+
+            /// \brief get number of passes, including disabled ones
+            /// \returns size_t
+            size_t get_n_passes() const;
+
+            /// \brief remove all passes
+            void clear_passes();
+
+            /// \brief redirect rendering into the scene texture and clear it, resizes textures if the window resized
+            /// \param color: clear color
+            void begin(RGBA = RGBA(0, 0, 0, 1));
+
+            /// \brief run all enabled passes and write the result into the framebuffer bound before begin
+            void end();
+
+            /// \brief get texture holding the scene rendered between begin and end
+            /// \returns reference
+            RenderTexture& get_scene_texture();
+
+            /// \copydoc rat::RenderTarget::render
+            void render(const Renderable*, Shader& = *noop_shader, Transform = Transform()) const override;
+
+            /// \copydoc rat::RenderTarget::get_renderer
+            SDL_Renderer* get_renderer() override;
+
+            /// \copydoc rat::RenderTarget::get_global_transform
+            Transform get_global_transform() const override;
+
+            /// \copydoc rat::RenderTarget::set_global_transform
+            void set_global_transform(Transform) override;
+
+            /// \copydoc rat::RenderTarget::combine_transforms
+            Transform combine_transforms(Transform transform, Transform global_transform) const override;
+
+        private:
+            class Pass
+            {
+                public:
+                    std::unique_ptr<Shader> shader;
+                    bool enabled = true;
+            };
+
+            void draw_pass(const Shader&, const RenderTexture& input, bool flip);
+
+            Window* _window;
+            std::vector<Pass> _passes;
+
+            RenderTexture _scene,
+                          _ping,
+                          _pong;
+            size_t _n_samples;
+
+            Vector2ui _size = {0, 0};
+            bool _active = false,
+                 _flip_output = true; // false if the output is a render texture
+
+            static void initialize();
+            static inline GLNativeHandle _vertex_array_id = 0; // attribute-less, positions come from gl_VertexID
+            static inline Shader* _copy_shader = nullptr;      // used if no pass is enabled
+
+            static inline const std::string _vertex_shader_source = R"(
+                #version 330
+
+                uniform int _flip;
+
+                out vec2 _texture_coordinates;
+
+                void main()
+                {
+                    // triangle (-1, -1), (3, -1), (-1, 3) covers the viewport
+                    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+
+                    // textures store their top row first. The default framebuffer stores its bottom row first
+                    _texture_coordinates = _flip == 1 ? vec2(position.x, 1 - position.y) : position;
+                    gl_Position = vec4(position * 2 - 1, 0, 1);
+                }
+            )";
+
+            static inline const std::string _copy_fragment_shader_source = R"(
+                #version 330
+
+                in vec2 _texture_coordinates;
+                uniform sampler2D _texture;
+
+                out vec4 _fragment_color;
+
+                void main()
+                {
+                    _fragment_color = texture(_texture, _texture_coordinates);
+                }
+            )";
+    };
+}
+
+#include <.src/post_process_chain.inl>
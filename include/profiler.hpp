@@ -0,0 +1,137 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/28/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <.src/include_gl.hpp>
+
+// instrumentation macros, compile to nothing unless MOUSETRAP_ENABLE_PROFILER is defined
+#define MOUSETRAP_PROFILE_CONCAT_AUX(a, b) a##b
+#define MOUSETRAP_PROFILE_CONCAT(a, b) MOUSETRAP_PROFILE_CONCAT_AUX(a, b)
+
+#ifdef MOUSETRAP_ENABLE_PROFILER
+    /// \brief measure cpu time until the end of the enclosing scope, name has to be a string literal
+    #define PROFILE_SCOPE(name) rat::ProfileScope MOUSETRAP_PROFILE_CONCAT(_profile_scope_, __LINE__)(name)
+
+    /// \brief measure gpu time of all OpenGL commands until the end of the enclosing scope, name has to be a string literal
+    #define PROFILE_GPU_SCOPE(name) rat::GpuProfileScope MOUSETRAP_PROFILE_CONCAT(_gpu_profile_scope_, __LINE__)(name)
+
+    /// \brief mark the end of a frame, collects finished gpu measurements
+    #define PROFILE_FRAME() rat::Profiler::end_frame()
+#else
+    #define PROFILE_SCOPE(name)
+    #define PROFILE_GPU_SCOPE(name)
+    #define PROFILE_FRAME()
+#endif
+
+namespace rat
+{
+    /// \brief collects timed scopes from all threads, exportable as chrome trace
+    /// \note each thread records into its own ring buffer without locking, only the first event on a thread takes a lock
+    /// to register the buffer. Once a ring buffer is full, the oldest events are overwritten. Export should happen while
+    /// no other thread is recording
+    class Profiler
+    {
+        public:
+            /// \brief number of events kept per thread
+            static inline const size_t events_per_thread = 1 << 14;
+
+            /// \brief number of gpu measurements that may be in flight at the same time
+            static inline const size_t n_gpu_queries = 64;
+
+            /// \brief collect finished gpu measurements, call once per frame on the render thread
+            static void end_frame();
+
+            /// \brief write all recorded events as chrome trace event json, viewable in chrome://tracing or perfetto
+            /// \param path: file to write to
+            /// \returns true if the file was written
+            static bool export_chrome_trace(const std::string& path);
+
+            /// \brief discard all recorded events
+            static void clear();
+
+            /// \brief get nanoseconds since the profiler epoch
+            /// \returns nanoseconds
+            static int64_t now();
+
+        private:
+            friend class ProfileScope;
+            friend class GpuProfileScope;
+
+            class Event
+            {
+                public:
+                    const char* name = nullptr;
+                    int64_t begin_ns = 0,
+                            duration_ns = 0;
+            };
+
+            // single producer ring, written by its owning thread only
+            class ThreadBuffer
+            {
+                public:
+                    std::array<Event, events_per_thread> events;
+                    std::atomic<size_t> n_written = 0; // total, index is n_written % events_per_thread
+                    size_t thread_index = 0;
+
+                    void push(Event);
+            };
+
+            static ThreadBuffer& get_thread_buffer();
+
+            static inline std::mutex _registry_mutex;
+            static inline std::vector<std::unique_ptr<ThreadBuffer>> _thread_buffers; // owned here, outlive their thread
+            static inline const auto _epoch = std::chrono::steady_clock::now();
+
+            // gpu: GL_TIME_ELAPSED queries can't nest, inner gpu scopes are ignored
+            class PendingQuery
+            {
+                public:
+                    GLNativeHandle query = 0;
+                    Event event;
+            };
+
+            static bool begin_gpu_query(const char* name);
+            static void end_gpu_query();
+
+            static inline std::vector<GLNativeHandle> _free_queries;
+            static inline std::vector<PendingQuery> _pending_queries;
+            static inline bool _gpu_query_active = false;
+            static ThreadBuffer& get_gpu_buffer();
+    };
+
+    /// \brief RAII cpu scope, use PROFILE_SCOPE instead of constructing directly
+    class ProfileScope
+    {
+        public:
+            ProfileScope(const char* name);
+            ~ProfileScope();
+
+        private:
+            const char* _name;
+            int64_t _begin_ns;
+    };
+
+    /// \brief RAII gpu scope, use PROFILE_GPU_SCOPE instead of constructing directly. Render thread only
+    class GpuProfileScope
+    {
+        public:
+            GpuProfileScope(const char* name);
+            ~GpuProfileScope();
+
+        private:
+            bool _active;
+    };
+}
+
+#include <.src/profiler.inl>
@@ -0,0 +1,106 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/25/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <.src/include_gl.hpp>
+#include <include/renderable.hpp>
+#include <include/render_target.hpp>
+#include <include/shader.hpp>
+#include <include/transform.hpp>
+#include <include/opengl_common.hpp>
+#include <include/command_buffer.hpp>
+
+namespace rat
+{
+    /// \brief key determining the draw order of a submission, compared as an unsigned integer
+    /// \note bit layout, most to least significant:<br>
+    ///     opaque: 16 bit shader program | 16 bit texture | 16 bit inverted layer | 16 bit unused<br>
+    ///     transparent: 16 bit layer | 16 bit depth | 16 bit shader program | 16 bit texture
+    using RenderSortKey = uint64_t;
+
+    /// \brief collects render submissions and issues them in sorted order, instead of in call order
+    /// \note submissions are split into two passes: opaque objects are drawn first with depth writes enabled, grouped by
+    /// shader and texture, front-to-back. Their order does not matter as the depth test resolves overlap. Transparent
+    /// objects are drawn afterwards, back-to-front by layer and depth, without writing depth. Within each pass,
+    /// consecutive shapes sharing shader and texture are batched into one draw call, see rat::CommandBuffer
+    class RenderQueue
+    {
+        public:
+            /// \brief create the queue
+            /// \param render_target: target all submissions will be rendered to on flush
+            RenderQueue(RenderTarget*);
+
+            /// \brief add an object to the queue, it will not be rendered until `flush` is called
+            /// \param renderable: object to render, has to stay alive until the next flush
+            /// \param shader: shader to use, has to stay alive until the next flush
+            /// \param transform: transform handed to the object on render
+            /// \param depth: in [0, 1], transparent objects on the same layer are drawn with ascending depth
+            /// \note the layer is queried from the renderable, see rat::Renderable::get_layer
+            void submit(const Renderable*, Shader& = *noop_shader, Transform = Transform(), float depth = 0);
+
+            /// \brief sort all submissions and render them, then clear the queue
+            void flush();
+
+            /// \brief discard all submissions without rendering them
+            void clear();
+
+            /// \brief get number of submissions since the last flush
+            /// \returns size_t
+            size_t get_n_submissions() const;
+
+            /// \brief get render target
+            /// \returns pointer to target
+            RenderTarget* get_render_target() const;
+
+            /// \brief set render target, takes effect at the next flush
+            /// \param target
+            void set_render_target(RenderTarget*);
+
+            /// \brief assemble the sort key of an opaque submission
+            /// \param shader: native handle of the shader program, only the lower 16 bit are used
+            /// \param texture: native handle of the texture, only the lower 16 bit are used
+            /// \param layer: in [0, max_layer], higher layers are drawn first
+            /// \returns key
+            static RenderSortKey make_opaque_sort_key(GLNativeHandle shader, GLNativeHandle texture, size_t layer);
+
+            /// \brief assemble the sort key of a transparent submission
+            /// \param layer: in [0, max_layer], most significant
+            /// \param depth: in [0, 1], quantized to 16 bit
+            /// \param shader: native handle of the shader program, only the lower 16 bit are used
+            /// \param texture: native handle of the texture, only the lower 16 bit are used
+            /// \returns key
+            static RenderSortKey make_transparent_sort_key(size_t layer, float depth, GLNativeHandle shader, GLNativeHandle texture);
+
+        private:
+            class Submission
+            {
+                public:
+                    const Renderable* renderable;
+                    Shader* shader;
+                    Transform transform;
+            };
+
+            RenderTarget* _target;
+
+            std::vector<Submission> _submissions;
+
+            // (key, index into _submissions), sorted by key in-place
+            using KeyIndexPair = std::pair<RenderSortKey, uint32_t>;
+            std::vector<KeyIndexPair> _opaque_keys,
+                                      _transparent_keys,
+                                      _keys_swap;
+
+            void sort(std::vector<KeyIndexPair>&);
+            void render_pass(const std::vector<KeyIndexPair>&, CommandBuffer&);
+
+            static inline const RenderSortKey _16_bit_mask = 0xFFFF;
+    };
+}
+
+#include <.src/render_queue.inl>
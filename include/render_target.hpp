@@ -21,5 +21,14 @@ namespace rat
 
             virtual SDL_Renderer* get_renderer() = 0;
             virtual void render(const Renderable*, Shader&, Transform) const = 0;
+
+            /// \brief combine a per-call transform with a global transform, in the order renderables apply them to their vertices
+            /// \param transform: per-call transform
+            /// \param global_transform: global transform of this target, as returned by get_global_transform
+            /// \returns transform
+            virtual Transform combine_transforms(Transform transform, Transform global_transform) const
+            {
+                return transform.combine_with(global_transform);
+            }
     };
 }
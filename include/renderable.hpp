@@ -5,12 +5,15 @@
 
 #pragma once
 
+#include <.src/include_gl.hpp>
 #include <include/transform.hpp>
 #include <include/shader.hpp>
 
 namespace rat
 {
     class RenderTarget;
+    class CommandBuffer;
+
     struct Renderable
     {
         /// \brief render
@@ -18,5 +21,34 @@ namespace rat
         /// \param transform: transform to be applied to position attribute of vertices
         /// \param shader: shader to be used, or nullptr to use the identity shader
         virtual void render(const RenderTarget*, Shader&, Transform) const = 0;
+
+        /// \brief record into a command buffer instead of rendering immediately, does not call into OpenGL
+        /// \param command_buffer: buffer to record into
+        /// \param shader: shader to be used on submission
+        /// \param transform: transform to be applied to position attribute of vertices
+        /// \note by default, records a deferred call to render, see CommandBuffer::record_render_call. Override to prepare
+        /// geometry on the recording thread
+        virtual void record(CommandBuffer&, Shader&, Transform) const;
+
+        /// \brief get native handle of the texture used during rendering, used for sorting submissions
+        /// \returns handle, or 0 if the renderable is not textured
+        virtual GLNativeHandle get_native_texture_handle() const
+        {
+            return 0;
+        }
+
+        /// \brief get z-layer, used for depth testing and sorting submissions
+        /// \returns layer, higher layers are drawn on top
+        virtual size_t get_layer() const
+        {
+            return 0;
+        }
+
+        /// \brief whether every fragment rendered is fully opaque, opaque objects may be drawn in any order
+        /// \returns false if unknown
+        virtual bool is_opaque() const
+        {
+            return false;
+        }
     };
 }
\ No newline at end of file
@@ -7,6 +7,8 @@
 
 #include <vector>
 #include <array>
+#include <unordered_map>
+#include <memory>
 
 #include <.src/include_gl.hpp>
 #include <include/renderable.hpp>
@@ -16,6 +18,7 @@
 #include <include/common.hpp>
 #include <include/angle.hpp>
 #include <include/shader.hpp>
+#include <include/streaming_buffer.hpp>
 
 namespace rat
 {
@@ -40,19 +43,42 @@ namespace rat
             Shape(Shape&&);
             Shape& operator=(Shape&&);
 
-            // primitives
+            // primitives, all are rendered as indexed GL_TRIANGLES
             void as_triangle(Vector2f a, Vector2f b, Vector2f c);
             void as_rectangle(Vector2f top_left, Vector2f size);
             void as_circle(Vector2f center, float radius, size_t n_outer_vertices);
-            void as_line(Vector2f a, Vector2f b);
-            void as_line_strip(std::vector<Vector2f>);  // may overlap
-            void as_polygon(std::vector<Vector2f> positions); // bounding polygon
-            void as_wireframe(std::vector<Vector2f>);         // bounding polygon
+            void as_circle(Vector2f center, float radius); // number of vertices chosen by get_circle_lod, without zoom
+            void as_circle(Vector2f center, float radius, const RenderTarget&); // same, zoom taken from the targets global transform
+            void as_line(Vector2f a, Vector2f b, float width = 1);
+            void as_line_strip(std::vector<Vector2f>, float width = 1);  // may overlap
+            void as_polygon(std::vector<Vector2f> positions); // outline in order, may be concave
+            void as_wireframe(std::vector<Vector2f>, float width = 1);   // bounding polygon
 
             // compound shapes
             void as_frame(Vector2f top_left, Vector2f size, float width);
 
             virtual void render(const RenderTarget*, Shader& shader = *noop_shader, Transform = Transform()) const override;
+            virtual void record(CommandBuffer&, Shader& shader = *noop_shader, Transform = Transform()) const override;
+            virtual GLNativeHandle get_native_texture_handle() const override;
+
+            /// \brief set z-layer, objects on higher layers are drawn on top if depth testing is enabled
+            /// \param layer: in [0, max_layer]
+            void set_layer(size_t);
+
+            /// \copydoc rat::Renderable::get_layer
+            virtual size_t get_layer() const override;
+
+            /// \brief shape is opaque if it is untextured and all vertices have an alpha of 1
+            /// \returns bool
+            virtual bool is_opaque() const override;
+
+            /// \brief set how often the shapes vertices are expected to change
+            /// \param usage: if STREAM, positions are uploaded through a triple-buffered rat::StreamingBuffer on render
+            void set_buffer_usage(BufferUsage);
+
+            /// \brief get usage hint, STATIC by default
+            /// \returns usage
+            BufferUsage get_buffer_usage() const;
 
             Rectangle get_texture_rectangle() const;
             void set_texture_rectangle(Rectangle normalized);
@@ -81,8 +107,7 @@ namespace rat
 
             Texture* get_texture() const;
 
-            template<typename Texture_t>
-            void set_texture(Texture_t texture);
+            void set_texture(Texture*);
 
             Rectangle get_bounding_box() const;
             Vector2f get_size() const;
@@ -92,7 +117,15 @@ namespace rat
 
             void rotate(Angle);
             void scale(float x_factor, float y_factor);
-            
+
+            /// \brief get number of outer vertices needed for a circle to look round on screen
+            /// \param radius: radius, in pixels
+            /// \param zoom: zoom of the camera the circle is viewed through, see rat::Camera::get_zoom
+            /// \param tolerance: maximum distance between the outline and a true circle, in on-screen pixels, if 0, the
+            /// maximum number of vertices is used
+            /// \returns number of vertices, multiple of 4 in [8, 512]
+            static size_t get_circle_lod(float radius, float zoom = 1, float tolerance = 0.25);
+
         protected:
             std::vector<Vertex> _vertices; // in sdl coordinates
             void update_positions();
@@ -106,8 +139,59 @@ namespace rat
             void initialize();
             void align_texture_rectangle_with_bounding_box(); // align texture top left with aabb top left
 
+            // cached aabb and centroid, kept in sync with _vertices so queries are O(1)
+            void update_bounds();                 // full recompute, O(n)
+            void translate_bounds(Vector2f delta); // shift cache after uniform move, O(1)
+            void update_bounds(Vector3f old_position, Vector3f new_position); // single vertex changed
+
+            Rectangle _bounding_box = Rectangle{{0, 0}, {0, 0}};
+            Vector2f _centroid = Vector2f(0, 0);
+
             std::vector<Vector2f> sort_by_angle(const std::vector<Vector2f>&);
 
+            // regular polygon inscribed into the unit circle, cached per vertex count
+            class UnitPolygon
+            {
+                public:
+                    std::vector<Vector2f> vertices;
+                    std::vector<uint32_t> indices; // triangles around center vertex at index 0
+            };
+
+            static inline std::unordered_map<size_t, UnitPolygon> _unit_polygon_cache;
+            static const UnitPolygon& get_unit_polygon(size_t n_vertices);
+
+            // ear clipping, returns indices for GL_TRIANGLES, or empty if two non-adjacent edges of the outline cross or
+            // touch. O(n^2)
+            static std::vector<uint32_t> triangulate(const std::vector<Vector2f>& outline);
+
+            // triangulation of an outline, relative to its first point so translated copies share an entry
+            class Triangulation
+            {
+                public:
+                    std::vector<Vector2f> outline;
+                    std::vector<uint32_t> indices;
+            };
+
+            static inline std::unordered_map<size_t, std::vector<Triangulation>> _triangulation_cache; // by hash of outline
+            static inline size_t _triangulation_cache_size = 0;
+            static inline const size_t _max_triangulation_cache_size = 1024; // cache is cleared when exceeded
+            static std::vector<uint32_t> get_triangulation(const std::vector<Vector2f>& outline);
+
+            // expand a polyline into quads of given width, with miter joins, or bevel joins where the miter would be
+            // too long. Replaces _vertices and _indices
+            void as_thick_polyline(const std::vector<Vector2f>& points, float width, bool closed);
+            static inline const float _miter_limit = 4; // factor of half width, longer miters become bevels
+
+            // upload to the buffer bound to target, only reallocates storage if the size changed
+            // n_allocated: size of the buffers storage, in bytes, updated on reallocation
+            void upload(GLenum target, const void* data, size_t n_bytes, size_t& n_allocated) const;
+
+            BufferUsage _buffer_usage = BufferUsage::STATIC;
+            mutable std::unique_ptr<StreamingBuffer> _streaming_position_buffer; // only allocated for STREAM
+
+            // append transformed vertex positions, in gl coordinates, to out. Does not call into OpenGL
+            void transform_positions(Transform, Vector2f viewport_size, std::vector<float>& out) const;
+
             static inline bool _noop_shader_initialized = false;
             static inline Shader* _noop_shader = nullptr;
 
@@ -116,10 +200,11 @@ namespace rat
             Texture* _texture = nullptr;
             Rectangle _texture_rect = Rectangle{{0, 0}, {1, 1}};
 
-            GLenum _render_type = GL_TRIANGLE_FAN;
-
             Vector2f _origin = Vector2f(0, 0);
 
+            size_t _layer = 0;
+            bool _all_vertices_opaque = true;
+
             std::vector<float> _positions, // in gl coordinates
                                _colors,
                                _texture_coordinates;
@@ -130,29 +215,23 @@ namespace rat
                     _color_buffer_id,
                     _texture_coordinate_buffer_id;
 
-            static inline const float _default_z = 1;
-
-            // sfinae needed to automatically flip when using render textures only (thanks SDL)
-            template<typename Texture_t, std::enable_if_t<std::is_same_v<Texture_t, StaticTexture>, bool> = true>
-            void set_texture_aux(Texture_t* texture);
-
-            template<typename Texture_t, std::enable_if_t<std::is_same_v<Texture_t, DynamicTexture>, bool> = true>
-            void set_texture_aux(Texture_t* texture);
-
-            template<typename Texture_t, std::enable_if_t<std::is_same_v<Texture_t, nullptr_t>, bool> = true>
-            void set_texture_aux(Texture_t texture);
+            // size of each buffers storage, tracked so uploads do not have to query it from the driver
+            mutable size_t _element_buffer_n_bytes = 0,
+                           _position_buffer_n_bytes = 0,
+                           _color_buffer_n_bytes = 0,
+                           _texture_coordinate_buffer_n_bytes = 0;
 
-            template<typename Texture_t, std::enable_if_t<std::is_same_v<Texture_t, RenderTexture>, bool> = true>
-            void set_texture_aux(Texture_t* texture);
+            static inline const float _default_z = 1; // depth of layer 0
     };
 
     Shape TriangleShape(Vector2f a, Vector2f b, Vector2f c);
     Shape RectangleShape(Vector2f top_left, Vector2f size);
     Shape CircleShape(Vector2f center, float radius, size_t n_outer_vertices);
-    Shape LineShape(Vector2f a, Vector2f b);
-    Shape LineStripShape(std::vector<Vector2f>);
+    Shape CircleShape(Vector2f center, float radius);
+    Shape LineShape(Vector2f a, Vector2f b, float width = 1);
+    Shape LineStripShape(std::vector<Vector2f>, float width = 1);
     Shape PolygonShape(std::vector<Vector2f> positions);
-    Shape WireframeShape(std::vector<Vector2f>);
+    Shape WireframeShape(std::vector<Vector2f>, float width = 1);
     Shape FrameShape(Vector2f top_left, Vector2f size, float width);
 }
 
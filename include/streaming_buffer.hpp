@@ -0,0 +1,89 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/27/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <array>
+
+#include <.src/include_gl.hpp>
+
+namespace rat
+{
+    /// \brief hint on how often the vertex data of an object changes
+    enum class BufferUsage
+    {
+        /// \brief data is set once and rendered many times
+        STATIC = GL_STATIC_DRAW,
+
+        /// \brief data changes occasionally, for example on user input
+        DYNAMIC = GL_DYNAMIC_DRAW,
+
+        /// \brief data changes every frame, vertex positions are uploaded through a rat::StreamingBuffer
+        STREAM = GL_STREAM_DRAW
+    };
+
+    /// \brief gpu buffer for data that is rewritten every frame, without stalling on buffers still in use by the gpu
+    /// \note the buffer is split into n_regions regions, one per frame, which are used round-robin. All writes during a
+    /// frame are appended to the same region, regions grow to hold everything written during the previous frame. If
+    /// ARB_buffer_storage is available, the buffer is persistently mapped and each region is guarded by a fence that
+    /// is only waited on when the region is reused, otherwise the buffer storage is orphaned each time the next region
+    /// is started. Has to be used on the render thread only
+    class StreamingBuffer
+    {
+        public:
+            /// \brief number of regions, writes wait only if the gpu is this many frames behind
+            static inline const size_t n_regions = 3;
+
+            /// \brief create the buffer, gpu-side storage is allocated on first write
+            /// \param target: binding point, usually GL_ARRAY_BUFFER
+            StreamingBuffer(GLenum target = GL_ARRAY_BUFFER);
+
+            /// \brief dtor, waits for pending fences and frees the storage
+            ~StreamingBuffer();
+
+            StreamingBuffer(const StreamingBuffer&) = delete;
+            StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+            /// \brief append data to the region of the current frame and leave the buffer bound
+            /// \param data: pointer to data
+            /// \param n_bytes: size of data, regions grow if it does not fit
+            /// \returns offset of the data in bytes, to be used as the attribute pointer or index offset
+            size_t write(const void* data, size_t n_bytes);
+
+            /// \brief mark the region written last as in use, call after all draw calls reading it were issued. May be
+            /// called after every write, the last fence of a frame guards the whole region
+            void fence();
+
+            /// \brief get native OpenGL handle
+            /// \returns handle, or 0 if nothing was written yet
+            GLNativeHandle get_native_handle() const;
+
+            /// \brief get whether the buffer uses persistent mapping
+            /// \returns false if the orphaning fallback is used
+            bool is_persistent() const;
+
+        private:
+            void allocate(size_t region_size);
+            void free();
+
+            GLenum _target;
+            GLNativeHandle _buffer_id = 0;
+
+            bool _persistent = false;
+            void* _mapped = nullptr;
+
+            size_t _region_size = 0; // in bytes
+            static inline const size_t _min_region_size = 4096;
+            size_t _current_region = 0;
+
+            size_t _region_offset = 0; // bytes used in the current region
+            size_t _frame = 0;         // detail::frame_index of the last write
+            size_t _n_bytes_frame = 0; // bytes written during that frame, across all regions it used
+
+            std::array<GLsync, n_regions> _fences = {};
+    };
+}
+
+#include <.src/streaming_buffer.inl>
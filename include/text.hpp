@@ -160,6 +160,16 @@ namespace rat
             /// \copydoc rat::Renderable::render
             void render(const RenderTarget* target, Shader& shader = *noop_shader, Transform transform = Transform()) const override;
 
+            /// \copydoc rat::Renderable::record
+            void record(CommandBuffer&, Shader& shader = *noop_shader, Transform transform = Transform()) const override;
+
+            /// \brief set z-layer of all glyphs
+            /// \param layer: in [0, max_layer]
+            void set_layer(size_t);
+
+            /// \copydoc rat::Renderable::get_layer
+            size_t get_layer() const override;
+
             /// \brief update the texts animations
             /// \param time: time elapsed since last frame, usually return value of `rat::Window::update`
             virtual void update(Time);
@@ -218,11 +228,20 @@ namespace rat
             int _line_spacer = 1;
             size_t _width = -1;
             float _font_size;
+            size_t _layer = 0;
 
             void apply_wrapping();
             std::deque<Glyph> _glyphs = {};
 
+            // cached extent of all glyphs, updated after layout and on every move
+            void update_bounding_box();
+            Rectangle _bounding_box = Rectangle{{0, 0}, {0, 0}};
+
             size_t glyph_to_hash(Glyph&);
+
+            // transform of glyph i, including shake and wave offsets
+            Transform get_glyph_transform(size_t i, Transform base) const;
+            bool is_glyph_visible(size_t i) const;
             std::unordered_map<size_t, StaticTexture> _glyph_texture_index;
 
             std::set<size_t> _shake_indices,
@@ -5,9 +5,15 @@
 
 #pragma once
 
+#include <set>
+
 #include <SDL2/SDL_render.h>
 #include <.src/include_gl.hpp>
+#include <include/frame_stats.hpp>
 #include <include/image.hpp>
+#include <include/async_download.hpp>
+#include <include/asset_file.hpp>
+#include <include/streaming_buffer.hpp>
 
 namespace rat
 {
@@ -40,7 +46,6 @@ namespace rat
             Texture& operator=(Texture&&);
 
             Vector2ui get_size() const;
-            SDL_Texture* get_native();
 
             void set_wrap_mode(WrapMode);
             WrapMode get_wrap_mode() const;
@@ -48,6 +53,14 @@ namespace rat
             void set_filter_mode(FilterMode);
             FilterMode get_filter_mode() const;
 
+            /// \brief generate mipmaps from the current content, the filter mode uses them from then on
+            /// \note has to be called again after the content changed
+            void generate_mipmaps();
+
+            /// \brief get whether mipmaps were generated
+            /// \returns bool
+            bool has_mipmaps() const;
+
             void bind();
             void unbind();
             bool valid() const;
@@ -57,9 +70,18 @@ namespace rat
         protected:
             Texture(RenderTarget&);
 
-            SDL_Texture* _native;
-            SDL_Renderer* _renderer;
-            mutable GLNativeHandle _native_handle = 0;
+            /// \brief allocate the OpenGL texture if needed and upload a surface with glTexImage2D
+            /// \note RGBA32, BGRA32, RGB24 and BGR24 surfaces are uploaded as is, other formats are converted first
+            /// \returns true if successful
+            bool upload(SDL_Surface*);
+
+            /// \brief write wrap and filter mode into the OpenGL texture object
+            void apply_parameters();
+
+            bool _has_mipmaps = false;
+
+            GLNativeHandle _native_handle = 0;
+            Vector2ui _size = {0, 0};
             bool _initialized = false;
 
         private:
@@ -74,49 +96,166 @@ namespace rat
             StaticTexture(RenderTarget&);
 
             void create(size_t width, size_t height, RGBA color = RGBA(1, 1, 1, 1));
-            void create_from(SDL_Surface*);
-            void create_from(Image&);
-            void load(const std::string& path);
+
+            /// \brief upload a surface, the surface is not freed
+            /// \param surface
+            /// \param generate_mipmaps: if true, mipmaps are generated after upload
+            void create_from(SDL_Surface*, bool generate_mipmaps = false);
+
+            /// \brief upload an image, its pixels are copied without conversion
+            /// \param image
+            /// \param generate_mipmaps: if true, mipmaps are generated after upload
+            void create_from(Image&, bool generate_mipmaps = false);
+
+            /// \brief load an image file and upload it
+            /// \param path: absolute path
+            /// \param generate_mipmaps: if true, mipmaps are generated after upload
+            void load(const std::string& path, bool generate_mipmaps = false);
+
+            /// \brief upload all levels of a cooked asset straight from its mapping, no decoding or mipmap generation
+            /// \param asset: opened asset file, may be closed after this call
+            /// \returns false if the asset is not open
+            bool create_from(const AssetFile&);
+
+            /// \brief map a cooked asset file and upload it
+            /// \param path: absolute path to a file written by AssetFile::write or mousetrap_cook
+            /// \returns false if the file could not be opened
+            bool load_asset(const std::string& path);
     };
 
     /// \brief texture, can be modified once gpu-side
+    /// \note owned by OpenGL. Updates copy whole rows with glTexSubImage2D, optionally through a streaming pixel buffer,
+    /// so copying into driver memory does not wait for the gpu to finish reading the previous content
     class DynamicTexture : public Texture
     {
         public:
             DynamicTexture(RenderTarget&);
 
+            /// \brief allocate storage, content is undefined until updated
+            /// \param width: x-dimension, in pixels
+            /// \param height: y-dimension, in pixels
             void create(size_t width, size_t height);
+
+            /// \brief load an image file, create a texture of the same size and upload it
+            /// \param path: absolute path
             void load(const std::string& path);
 
-            void update(Image& image, Vector2ui top_left = {0, 0});
+            /// \brief copy a whole image into the texture
+            /// \param image
+            /// \param top_left: position in the texture, parts outside the texture are skipped
+            void update(const Image& image, Vector2ui top_left = {0, 0});
+
+            /// \brief copy part of an image into the texture
+            /// \param image
+            /// \param source_top_left: top left corner of the region in the image
+            /// \param source_size: size of the region, clipped to the image
+            /// \param top_left: position in the texture, parts outside the texture are skipped
+            void update(const Image& image, Vector2ui source_top_left, Vector2ui source_size, Vector2ui top_left);
+
+            /// \brief copy raw pixels into the texture
+            /// \param pixels: bytes r, g, b, a per pixel, top row first
+            /// \param pitch: distance between the starts of two rows, in bytes, a multiple of 4
+            /// \param size: number of pixels per row and number of rows
+            /// \param top_left: position in the texture, parts outside the texture are skipped
+            void update(const void* pixels, size_t pitch, Vector2ui size, Vector2ui top_left = {0, 0});
+
+            /// \brief set whether updates go through a streaming pixel buffer, which pays off for textures rewritten
+            /// every frame, e.g. video
+            /// \param b: false by default
+            void set_use_pixel_buffer(bool);
+
+            /// \brief get whether updates go through a streaming pixel buffer
+            /// \returns bool
+            bool get_use_pixel_buffer() const;
+
+        private:
+            std::unique_ptr<StreamingBuffer> _pixel_buffer; // created on first use
+            bool _use_pixel_buffer = false;
     };
 
     /// \brief render texture, is a render target
+    /// \note backed by an OpenGL framebuffer object, independent of the SDL renderer. Content is stored top row first,
+    /// like all other textures, so it can be used with a shape without flipping texture coordinates
     class RenderTexture : public Texture, public RenderTarget
     {
         public:
             RenderTexture(Window&);
+            ~RenderTexture();
+
+            /// \brief allocate texture and framebuffer, frees previous ones
+            /// \param width: x-dimension, in pixels
+            /// \param height: y-dimension, in pixels
+            /// \param depth_stencil: attach a depth and stencil buffer, needed for layered rendering into the texture
+            /// \param n_samples: number of msaa samples, 0 to disable. If enabled, rendering goes to a multisampled
+            /// buffer, which is resolved into the texture on unbind_as_render_target
+            virtual void create(size_t width, size_t height, bool depth_stencil = false, size_t n_samples = 0);
 
-            virtual void create(size_t width, size_t height);
+            /// \brief queue a copy of the texture into ram, without waiting for the gpu
+            /// \returns handle, call AsyncDownload::get a few frames later to retrieve the pixels without stalling
+            AsyncDownload download_async();
 
+            /// \brief copy the texture into ram, blocks until all rendering to it is done
+            /// \param image: reallocated if its size does not match
+            void download(Image&);
+
+            /// \brief redirect all rendering into the texture until unbind_as_render_target is called
             void bind_as_render_target();
+
+            /// \brief restore the previous framebuffer and viewport, resolves multisampling
             void unbind_as_render_target();
 
+            /// \brief get native OpenGL handle of the framebuffer that holds the resolved texture
+            /// \returns handle, 0 if not created
+            GLNativeHandle get_framebuffer_handle() const;
+
+            /// \brief get whether a framebuffer belongs to a render texture, which store their top row first, unlike the
+            /// default framebuffer
+            /// \param framebuffer: native OpenGL handle, for example the current GL_DRAW_FRAMEBUFFER_BINDING
+            /// \returns bool
+            static bool is_render_texture_framebuffer(GLNativeHandle framebuffer);
+
+            /// \brief get number of msaa samples
+            /// \returns 0 if multisampling is disabled
+            size_t get_n_samples() const;
+
+            /// \brief get global transform, includes the y-flip that stores the top row in texture row 0
+            /// \returns transform
             virtual Transform get_global_transform() const;
             virtual void set_global_transform(Transform);
             virtual SDL_Renderer* get_renderer();
 
+            /// \brief combine transforms such that the y-flip is applied last, the per-call transform acts in sdl coordinates
+            /// \param transform: per-call transform
+            /// \param global_transform: as returned by get_global_transform
+            /// \returns transform
+            virtual Transform combine_transforms(Transform transform, Transform global_transform) const;
+
             void clear(RGBA = RGBA(0, 0, 0, 1));
             virtual void render(const Renderable*, Shader& = *noop_shader, Transform = Transform()) const;
 
         private:
+            void free();
+
             Window* _window;
 
+            GLNativeHandle _framebuffer_id = 0,
+                           _depth_stencil_buffer_id = 0,
+                           _multisample_framebuffer_id = 0,
+                           _multisample_color_buffer_id = 0;
+
+            size_t _n_samples = 0;
+            bool _has_depth_stencil = false;
+
             bool _currently_bound = false;
             Transform _global_transform = Transform();
+            Transform _flip_transform = Transform(); // maps the top row to texture row 0
 
             mutable Vector2ui _previous_viewport_size;
-            mutable Transform _previous_transform;
+            GLint _previous_framebuffer = 0;
+
+            static inline std::set<GLNativeHandle> _framebuffers = {}; // of all created render textures, including msaa ones
+
+            std::shared_ptr<PixelBufferRing> _download_ring;
     };
 }
 
@@ -0,0 +1,142 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/30/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <include/asset_file.hpp>
+#include <include/geometric_shapes.hpp>
+#include <include/image.hpp>
+#include <include/render_target.hpp>
+#include <include/texture.hpp>
+
+namespace rat
+{
+    /// \brief packs many images into a single texture, so objects using different images can be batched
+    /// \note images are placed with a skyline bottom-left packer. Each image is surrounded by padding that repeats its
+    /// edge pixels, so linear filtering and mipmapping do not bleed neighbouring images into it
+    class TextureAtlas
+    {
+        public:
+            /// \brief ctor
+            /// \param target: render target the texture is created for
+            /// \param padding: extruded border around each image, in pixels
+            /// \param max_size: largest allowed width or height of the atlas, in pixels
+            TextureAtlas(RenderTarget&, size_t padding = 2, size_t max_size = 4096);
+
+            /// \brief dtor, frees images that were added but not yet packed
+            ~TextureAtlas();
+
+            TextureAtlas(const TextureAtlas&) = delete;
+            TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+            /// \brief queue an image for packing, its pixels are copied
+            /// \param name: name of the region, replaces an earlier image with the same name
+            /// \param image
+            void add(const std::string& name, Image&);
+
+            /// \brief queue an image file for packing
+            /// \param name: name of the region
+            /// \param path: absolute path
+            /// \returns false if the file could not be loaded
+            bool add(const std::string& name, const std::string& path);
+
+            /// \brief pack all queued images together with the ones already packed, then upload the atlas
+            /// \param generate_mipmaps: if true, mipmaps are generated after upload
+            /// \returns false if the images do not fit into max_size x max_size, the previous atlas is kept in that case
+            bool pack(bool generate_mipmaps = false);
+
+            /// \brief get whether a region exists
+            /// \param name
+            /// \returns true if an image with that name was packed
+            bool has_region(const std::string& name) const;
+
+            /// \brief get region of an image in normalized texture coordinates, for Shape::set_texture_rectangle
+            /// \param name
+            /// \returns rectangle in [0, 1], or an empty rectangle if the name is unknown
+            Rectangle get_region(const std::string& name) const;
+
+            /// \brief get region of an image in pixels
+            /// \param name
+            /// \returns rectangle in pixels, or an empty rectangle if the name is unknown
+            Rectangle get_pixel_region(const std::string& name) const;
+
+            /// \brief get names of all packed regions
+            /// \returns vector of names, in alphabetical order
+            std::vector<std::string> get_region_names() const;
+
+            /// \brief get size of the atlas
+            /// \returns size in pixels, (0, 0) if not yet packed
+            Vector2ui get_size() const;
+
+            /// \brief get packed texture
+            /// \returns reference
+            StaticTexture& get_texture();
+
+            /// \brief write the atlas to disk
+            /// \param path: absolute path without extension, `.png` and `.atlas` files are written
+            /// \returns false if either file could not be written
+            bool save(const std::string& path) const;
+
+            /// \brief load an atlas written by save and upload it, without packing again
+            /// \param path: absolute path without extension
+            /// \param generate_mipmaps: if true, mipmaps are generated after upload
+            /// \returns false if either file could not be read, or a region lies outside the image
+            bool load(const std::string& path, bool generate_mipmaps = false);
+
+            /// \brief cook the packed atlas into a single binary asset, see AssetFile
+            /// \param path: absolute path of the output
+            /// \param generate_mipmaps: if true, all mip levels are generated now and stored in the file
+            /// \returns false if the atlas was not packed or the file could not be written
+            bool save_asset(const std::string& path, bool generate_mipmaps = false) const;
+
+            /// \brief load an atlas cooked by save_asset or mousetrap_cook, uploading its levels straight from the mapping
+            /// \param path: absolute path
+            /// \returns false if the file could not be opened or holds no regions
+            bool load_asset(const std::string& path);
+
+        private:
+            class Entry
+            {
+                public:
+                    std::string name;
+                    SDL_Surface* surface; // RGBA32, owned
+            };
+
+            class SkylineNode
+            {
+                public:
+                    size_t x, y, width;
+            };
+
+            // returns false if not all sizes fit, positions are top left corners of each padded cell
+            static bool skyline_pack(const std::vector<Vector2ui>& sizes, Vector2ui atlas_size, std::vector<Vector2ui>& positions);
+            static bool skyline_fit(const std::vector<SkylineNode>&, size_t index, Vector2ui size, Vector2ui atlas_size, size_t& y);
+
+            void blit_extruded(SDL_Surface* source, Vector2ui position);
+
+            // true if the region covers whole pixels inside an image of the given size
+            static bool is_region_inside(const Rectangle& region, Vector2ui size);
+
+            // copy every region of _image into _entries, replacing them, returns false if a copy could not be allocated
+            bool rebuild_entries();
+
+            size_t _padding,
+                   _max_size;
+
+            std::vector<Entry> _entries;              // everything that is part of the next pack
+            std::map<std::string, Rectangle> _regions; // in pixels
+
+            Image _image;
+            StaticTexture _texture;
+
+            static inline const std::string _metadata_header = "mousetrap_atlas 1";
+    };
+}
+
+#include <.src/texture_atlas.inl>
@@ -0,0 +1,66 @@
+//
+// Copyright 2022 Clemens Cords
+// Created on 7/31/22 by clem (mail@clemens-cords.com)
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace rat
+{
+    /// \brief fixed set of worker threads that run queued tasks in order of submission
+    class ThreadPool
+    {
+        public:
+            /// \brief ctor, starts the workers
+            /// \param n_threads: number of workers, if 0, one less than the number of hardware threads, at least 1
+            ThreadPool(size_t n_threads = 0);
+
+            /// \brief dtor, runs all remaining tasks, then joins the workers
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            /// \brief queue a task
+            /// \param function: callable without arguments, invoked on one of the workers
+            /// \returns future holding the result or the exception thrown by the function
+            template<typename Function_t>
+            auto submit(Function_t&& function) -> std::future<std::invoke_result_t<Function_t>>;
+
+            /// \brief split a range into one chunk per worker plus one for the calling thread and block until all are done
+            /// \param n: size of the range [0, n)
+            /// \param function: called with the begin and end of each chunk, must be safe to call concurrently
+            void parallel_for(size_t n, std::function<void(size_t, size_t)> function);
+
+            /// \brief block until the queue is empty and no task is running
+            void wait();
+
+            /// \brief get number of workers
+            /// \returns size_t
+            size_t get_n_threads() const;
+
+        private:
+            void work();
+
+            std::vector<std::thread> _threads;
+            std::deque<std::function<void()>> _queue;
+
+            std::mutex _mutex;
+            std::condition_variable _task_available,
+                                    _idle;
+
+            size_t _n_running = 0;
+            bool _stop = false;
+    };
+}
+
+#include <.src/thread_pool.inl>
@@ -17,10 +17,10 @@ namespace rat
         public:
             Transform();
 
-            Vector2f apply_to(Vector2f gl_coords);
-            Vector3f apply_to(Vector3f gl_coords);
+            Vector2f apply_to(Vector2f gl_coords) const;
+            Vector3f apply_to(Vector3f gl_coords) const;
 
-            Transform combine_with(Transform);
+            Transform combine_with(Transform) const;
 
             void rotate(Angle, Vector2f gl_coords);
             void set_rotation(Angle);
@@ -39,19 +39,19 @@ namespace rat
             : transform(1)
     {}
 
-    Vector2f Transform::apply_to(Vector2f point)
+    Vector2f Transform::apply_to(Vector2f point) const
     {
         return apply_to(Vector3f(point.x, point.y, 1));
     }
 
-    Vector3f Transform::apply_to(Vector3f point)
+    Vector3f Transform::apply_to(Vector3f point) const
     {
         Vector4f temp = Vector4f(point.x, point.y, point.z, 1);
         temp = transform * temp;
         return temp;
     }
 
-    Transform Transform::combine_with(Transform other)
+    Transform Transform::combine_with(Transform other) const
     {
         auto out = Transform();
         out.transform = this->transform * other.transform;
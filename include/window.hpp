@@ -16,6 +16,10 @@
 #include <include/vector.hpp>
 #include <include/time.hpp>
 #include <include/shader.hpp>
+#include <include/frame_limiter.hpp>
+#include <include/profiler.hpp>
+#include <include/frame_stats.hpp>
+#include <include/async_download.hpp>
 
 namespace rat
 {
@@ -30,7 +34,8 @@ namespace rat
         IS_UTILITY = 1 << 6,
         IS_TOOLTIP = 1 << 7,
         IS_POPUP_MENU = 1 << 8,
-        GRAB_FOCUS_ON_INIT = 1 << 9
+        GRAB_FOCUS_ON_INIT = 1 << 9,
+        HIDDEN = 1 << 10 // no visible window, for offscreen rendering
     };
 
     using WindowID = int32_t;
@@ -46,8 +51,38 @@ namespace rat
 
             void clear();
             void flush();
+
+            /// \brief end the frame, waits until the frame rate limit is reached unless vsync is enabled
             void display();
 
+            /// \brief enable or disable vsync, enabled by default. While enabled, the frame rate limit is ignored
+            /// \param b
+            void set_vsync(bool);
+
+            /// \brief get whether vsync is enabled
+            /// \returns bool
+            bool get_vsync() const;
+
+            /// \brief set frame rate limit used by display while vsync is disabled
+            /// \param fps: frames per second, or 0 for no limit
+            void set_frame_rate_limit(float);
+
+            /// \brief get frame rate limit
+            /// \returns frames per second, 0 if unlocked
+            float get_frame_rate_limit() const;
+
+            /// \brief get frame limiter, which measures real frame times regardless of vsync
+            /// \returns reference
+            const FrameLimiter& get_frame_limiter() const;
+
+            /// \brief get OpenGL work issued during the last completed frame, updated on every flush
+            /// \returns stats
+            const FrameStats& get_frame_stats() const;
+
+            /// \brief queue a copy of the back buffer into ram, call after rendering and before flush
+            /// \returns handle, call AsyncDownload::get a few frames later to retrieve the pixels without stalling
+            AsyncDownload download_async();
+
             void create(std::string title, size_t width, size_t height, uint32_t options = DEFAULT, size_t anti_aliasing_samples = 8);
             void set_icon(const std::string& path);
 
@@ -94,6 +129,16 @@ namespace rat
 
             Clock _clock;
 
+            FrameLimiter _frame_limiter = FrameLimiter(60);
+            bool _vsync_enabled = false;
+
+            FrameStats _frame_stats;
+
+            std::shared_ptr<PixelBufferRing> _download_ring;
+            GLNativeHandle _resolve_framebuffer_id = 0, // used by download_async if the window is multisampled
+                           _resolve_renderbuffer_id = 0;
+            Vector2ui _resolve_size = {0, 0};
+
             bool _is_open = false;
             bool _is_borderless;
             bool _is_resizable;
@@ -43,16 +43,27 @@ int main()
     text.set_alignment(Text::JUSTIFIED);
     text.create(window, {50, 50}, content, width, 1);
 
+    // animations advance in fixed steps, so their speed does not depend on frame time jitter
+    auto loop = FixedTimestepLoop(seconds(1.f / 60));
+
+    loop.set_update_function([&](Time timestep) {
+        text.update(timestep);
+    });
+
+    loop.set_render_function([&](float alpha) {
+        window.clear();
+        text.render(&window);
+        window.flush();
+    });
+
     while (not InputHandler::exit_requested())
     {
         InputHandler::update();
-        auto time = window.update();
+        window.update();
 
         if (InputHandler::was_pressed(ESCAPE))
             break;
 
-        window.clear();
-
         if (InputHandler::is_down(KeyboardKey::UP))
         {
             camera.move(0, -10);
@@ -102,15 +113,7 @@ int main()
             camera.center_on(shapes.front().get_centroid());
         }
 
-        auto clock = Clock();
-        text.update(time);
-        text.render(&window);
-
-        const float offset = 10;
-        //for (auto& shape : shapes)
-          //  shape.render(&window);
-
-        window.flush();
+        loop.step();
         window.display();
     }
 
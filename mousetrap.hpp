@@ -17,4 +17,19 @@
 #include <include/shape.hpp>
 #include <include/text.hpp>
 #include <include/rng.hpp>
-#include <include/camera.hpp>
\ No newline at end of file
+#include <include/camera.hpp>
+#include <include/render_queue.hpp>
+#include <include/command_buffer.hpp>
+#include <include/polyline.hpp>
+#include <include/fixed_timestep_loop.hpp>
+#include <include/profiler.hpp>
+#include <include/frame_stats.hpp>
+#include <include/frame_stats_overlay.hpp>
+#include <include/offscreen_target.hpp>
+#include <include/async_download.hpp>
+#include <include/post_process_chain.hpp>
+#include <include/texture_atlas.hpp>
+#include <include/asset_file.hpp>
+#include <include/thread_pool.hpp>
+#include <include/asset_loader.hpp>
+#include <include/image_ops.hpp>
\ No newline at end of file